@@ -0,0 +1,271 @@
+// checks the fleet wire format and times the aggregator's host table.
+//
+// the round trip encodes a varied metric stream and decodes every frame against the
+// last keyframe; the loss check drops frames on the way into a FleetTable and the
+// collision check feeds two senders with the same host id. the load check then
+// replays pre-encoded ticks from many hosts through FleetTable::apply, which is
+// everything the aggregator does per datagram apart from recvfrom.
+//
+// usage: FleetBench [hosts] [ticks]
+// exits non-zero if a check fails
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "FleetTable.h"
+#include "SnapshotCodec.h"
+
+namespace
+{
+constexpr size_t DEFAULT_HOSTS = 5000;
+constexpr size_t DEFAULT_TICKS = 60;
+constexpr size_t ROUND_TRIP_FRAMES = 200;
+
+using Frame = std::vector<uint8_t>;
+
+uint64_t mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// a plausible tick of host's metrics: values drift around a per-host level, some
+// metrics are missing now and then
+MetricTable syntheticTable(uint64_t host, uint64_t tick)
+{
+    MetricTable table;
+    for (size_t i = 0; i < METRIC_COUNT; i++)
+    {
+        uint64_t noise = mix(host * 1'000'003 + tick * METRIC_COUNT + i);
+        if (noise % 17 == 0)
+        {
+            continue;
+        }
+        auto level = static_cast<int64_t>(mix(host + i) % 100'000);
+        table.set(static_cast<MetricId>(i), level + static_cast<int64_t>(noise % 2001) - 1000);
+    }
+    return table;
+}
+
+Frame encode(SnapshotEncoder& encoder, const MetricTable& table)
+{
+    Frame frame(SnapshotEncoder::MAX_FRAME_SIZE);
+    frame.resize(encoder.encode(table, frame));
+    return frame;
+}
+
+bool sameTable(const MetricTable& a, const MetricTable& b)
+{
+    return a.validMask == b.validMask && a.values == b.values;
+}
+
+bool fail(const char *check, size_t frame)
+{
+    std::fprintf(stderr, "%s failed at frame %zu\n", check, frame);
+    return false;
+}
+
+bool checkRoundTrip()
+{
+    const std::string name = "build-01.\xE6\x9D\xB1\xE4\xBA\xAC";
+    SnapshotEncoder encoder(hostIdFromName(name), name);
+
+    MetricTable keyframe;
+    for (size_t i = 0; i < ROUND_TRIP_FRAMES; i++)
+    {
+        MetricTable table = syntheticTable(1, i);
+        // extremes must survive the zigzag varints too
+        if (i % 7 == 3)
+        {
+            table.set(METRIC_NETWORK, INT64_MIN / 2);
+            table.set(METRIC_DISK, INT64_MAX / 2);
+        }
+
+        Frame frame = encode(encoder, table);
+        if (frame.empty())
+        {
+            return fail("round trip: encode", i);
+        }
+
+        FrameReader reader(frame);
+        FrameHeader header;
+        MetricTable decoded;
+        if (!reader.readHeader(header)
+            || header.hostId != hostIdFromName(name)
+            || header.sequence != i
+            || header.keyframe != (i % SnapshotEncoder::KEYFRAME_INTERVAL == 0)
+            || !reader.readValues(keyframe, decoded)
+            || !sameTable(decoded, table))
+        {
+            return fail("round trip: values", i);
+        }
+
+        if (header.keyframe)
+        {
+            std::string decodedName;
+            if (!reader.readHostName(decodedName) || decodedName != name)
+            {
+                return fail("round trip: host name", i);
+            }
+            keyframe = decoded;
+        }
+    }
+    return true;
+}
+
+bool checkLoss()
+{
+    SnapshotEncoder encoder(7, "lossy");
+    FleetTable table;
+    constexpr uint32_t ADDRESS = 0x0100007F;
+    constexpr size_t INTERVAL = SnapshotEncoder::KEYFRAME_INTERVAL;
+
+    MetricTable lastApplied;
+    for (size_t i = 0; i < 4 * INTERVAL; i++)
+    {
+        MetricTable metrics = syntheticTable(7, i);
+        Frame frame = encode(encoder, metrics);
+
+        // every fifth delta and the second keyframe never arrive
+        bool lost = (i % INTERVAL != 0 && i % 5 == 0) || i == INTERVAL;
+        if (lost)
+        {
+            continue;
+        }
+
+        bool applied = table.apply(ADDRESS, frame);
+        bool expected = i < INTERVAL || i >= 2 * INTERVAL;
+        if (applied != expected)
+        {
+            return fail("loss: applied", i);
+        }
+        if (applied)
+        {
+            lastApplied = metrics;
+        }
+        if (table.hosts().size() != 1 || !sameTable(table.hosts()[0].metrics, lastApplied))
+        {
+            return fail("loss: values", i);
+        }
+    }
+
+    // a late delta must not roll the table back
+    SnapshotEncoder late(8, "late");
+    Frame keyframe = encode(late, syntheticTable(8, 0));
+    Frame first = encode(late, syntheticTable(8, 1));
+    Frame second = encode(late, syntheticTable(8, 2));
+    if (!table.apply(ADDRESS, keyframe) || !table.apply(ADDRESS, second) || table.apply(ADDRESS, first)
+        || !sameTable(table.hosts()[1].metrics, syntheticTable(8, 2)))
+    {
+        return fail("loss: reordered", 2);
+    }
+    return true;
+}
+
+bool checkCollision()
+{
+    // same host id, as two names whose hashes collide would produce
+    SnapshotEncoder a(42, "alpha");
+    SnapshotEncoder b(42, "bravo");
+    FleetTable table;
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (!table.apply(0x0100000A, encode(a, syntheticTable(1, i)))
+            || !table.apply(0x0200000A, encode(b, syntheticTable(2, i))))
+        {
+            return fail("collision: applied", i);
+        }
+    }
+
+    const std::vector<FleetHost>& hosts = table.hosts();
+    if (hosts.size() != 2
+        || hosts[0].name != L"alpha" || !sameTable(hosts[0].metrics, syntheticTable(1, 2))
+        || hosts[1].name != L"bravo" || !sameTable(hosts[1].metrics, syntheticTable(2, 2)))
+    {
+        return fail("collision: hosts", 2);
+    }
+    return true;
+}
+}
+
+int main(int argc, char **argv)
+{
+    size_t hostCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : DEFAULT_HOSTS;
+    size_t ticks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : DEFAULT_TICKS;
+    if (hostCount == 0 || ticks == 0)
+    {
+        std::fprintf(stderr, "usage: FleetBench [hosts] [ticks]\n");
+        return 1;
+    }
+
+    if (!checkRoundTrip() || !checkLoss() || !checkCollision())
+    {
+        return 1;
+    }
+    std::printf("round trip, loss and collision checks passed\n");
+
+    // every host's frames for every tick, interleaved as they would arrive
+    std::vector<SnapshotEncoder> encoders;
+    std::vector<uint32_t> addresses;
+    encoders.reserve(hostCount);
+    for (size_t h = 0; h < hostCount; h++)
+    {
+        std::string name = "host-" + std::to_string(h);
+        encoders.emplace_back(hostIdFromName(name), name);
+        // 10.0.0.0/8, network byte order
+        addresses.push_back(static_cast<uint32_t>(10 | (h + 1) << 8));
+    }
+
+    std::vector<Frame> frames;
+    frames.reserve(hostCount * ticks);
+    size_t keyframeBytes = 0;
+    size_t keyframes = 0;
+    size_t deltaBytes = 0;
+    for (size_t t = 0; t < ticks; t++)
+    {
+        for (size_t h = 0; h < hostCount; h++)
+        {
+            Frame& frame = frames.emplace_back(encode(encoders[h], syntheticTable(h, t)));
+            bool keyframe = t % SnapshotEncoder::KEYFRAME_INTERVAL == 0;
+            (keyframe ? keyframeBytes : deltaBytes) += frame.size();
+            keyframes += keyframe ? 1 : 0;
+        }
+    }
+
+    FleetTable table;
+    auto start = std::chrono::steady_clock::now();
+    size_t applied = 0;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        applied += table.apply(addresses[i % hostCount], frames[i]) ? 1 : 0;
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    bool allSynced = std::ranges::all_of(table.hosts(), &FleetHost::synced);
+    if (applied != frames.size() || table.hosts().size() != hostCount || !allSynced)
+    {
+        std::fprintf(stderr, "load: applied %zu of %zu frames into %zu hosts\n",
+                     applied, frames.size(), table.hosts().size());
+        return 1;
+    }
+
+    size_t deltas = frames.size() - keyframes;
+    std::printf("%zu hosts, %zu ticks, %zu frames\n", hostCount, ticks, frames.size());
+    std::printf("mean frame: keyframe %.1f bytes, delta %.1f bytes\n",
+                static_cast<double>(keyframeBytes) / static_cast<double>(keyframes),
+                deltas > 0 ? static_cast<double>(deltaBytes) / static_cast<double>(deltas) : 0.0);
+    std::printf("apply: %.2f ms total, %.0f ns per frame, %.2f ms per tick of all hosts\n",
+                elapsed.count(),
+                elapsed.count() * 1e6 / static_cast<double>(frames.size()),
+                elapsed.count() / static_cast<double>(ticks));
+    return 0;
+}
@@ -0,0 +1,107 @@
+// cold vs warm startup of the timer's glyph cache: a cold start resolves the font and
+// rasterizes the alphabet, a warm one maps the file the cold start left behind.
+// uses the same font, size and alphabet as DWriteEngine.
+//
+// usage: GlyphCacheBench [rounds] [dpi]
+
+#include <windows.h>
+#include <dwrite.h>
+#include <wrl/client.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include "GlyphCache.h"
+
+namespace
+{
+constexpr float FONT_SIZE = 128.0f;
+const wchar_t *FONT_FAMILY = L"Rounded Mplus 1c";
+const wchar_t *ALPHABET = L"0123456789:";
+
+double median(std::vector<double> values)
+{
+    std::ranges::sort(values);
+    return values[values.size() / 2];
+}
+
+// microseconds to construct one cache, and whether it came from the file
+double timeLoad(const Microsoft::WRL::ComPtr<IDWriteFactory>& factory, float dpi, bool& warm)
+{
+    auto start = std::chrono::steady_clock::now();
+    GlyphCache cache(factory, FONT_FAMILY, DWRITE_FONT_WEIGHT_BOLD, FONT_SIZE, dpi, ALPHABET);
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+    warm = cache.warm();
+    return elapsed.count();
+}
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 20;
+    float dpi = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 96.0f;
+    if (rounds <= 0 || dpi <= 0.0f)
+    {
+        std::fprintf(stderr, "usage: GlyphCacheBench [rounds] [dpi]\n");
+        return 1;
+    }
+
+    Microsoft::WRL::ComPtr<IDWriteFactory> factory;
+    if (FAILED(DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory), &factory)))
+    {
+        std::fprintf(stderr, "failed to create dwrite factory\n");
+        return 1;
+    }
+
+    std::filesystem::path path = GlyphCache::cachePath(FONT_SIZE, dpi);
+    if (path.empty())
+    {
+        std::fprintf(stderr, "no cache directory\n");
+        return 1;
+    }
+
+    // each round leaves a valid file behind, so the cache is usable afterwards
+    std::vector<double> cold;
+    std::vector<double> warm;
+    try
+    {
+        for (int i = 0; i < rounds; i++)
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+
+            bool fromFile = false;
+            cold.push_back(timeLoad(factory, dpi, fromFile));
+            if (fromFile)
+            {
+                std::fprintf(stderr, "cache file was not removed\n");
+                return 1;
+            }
+
+            warm.push_back(timeLoad(factory, dpi, fromFile));
+            if (!fromFile)
+            {
+                std::fprintf(stderr, "cache file could not be written or mapped\n");
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    double coldMedian = median(cold);
+    double warmMedian = median(warm);
+    std::printf("%d rounds at %.0f DPI\n", rounds, dpi);
+    std::printf("cold  median %10.1f us  max %10.1f us\n", coldMedian, *std::ranges::max_element(cold));
+    std::printf("warm  median %10.1f us  max %10.1f us\n", warmMedian, *std::ranges::max_element(warm));
+    std::printf("warm start is %.1fx faster\n", coldMedian / warmMedian);
+    return 0;
+}
\ No newline at end of file
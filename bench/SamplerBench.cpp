@@ -0,0 +1,215 @@
+// replays recorded metric traces through AdaptiveSampler and compares it with fixed
+// 1 Hz sampling: how many samples each takes and how far the value reconstructed from
+// those samples is from the full-resolution trace.
+//
+// trace files hold one "ms,value" row per line at a fixed step. a "# kind: rate" line
+// marks a rate counter, whose sample is the mean since the previous sample (as PDH
+// reports rates); otherwise the metric is a gauge, read as it is at the sample time.
+//
+// usage: SamplerBench [--sample-min ms] [--sample-max ms] trace.csv...
+// the bounds default to the window mode's
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AdaptiveSampler.h"
+
+namespace
+{
+// the rate every metric was sampled at before the adaptive sampler
+constexpr std::chrono::milliseconds FIXED_INTERVAL{1000};
+
+struct Trace
+{
+    std::string name;
+    bool rate = false;
+    long long step = 0;
+    std::vector<double> values;
+};
+
+struct Result
+{
+    size_t samples = 0;
+    double rmse = 0.0;
+    double maxError = 0.0;
+};
+
+bool loadTrace(const std::string& path, Trace& trace)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        return false;
+    }
+
+    trace.name = path.substr(path.find_last_of("/\\") + 1);
+    std::vector<long long> times;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+        if (line[0] == '#')
+        {
+            trace.rate = trace.rate || line.find("kind: rate") != std::string::npos;
+            continue;
+        }
+
+        size_t comma = line.find(',');
+        if (comma == std::string::npos)
+        {
+            return false;
+        }
+        try
+        {
+            times.push_back(std::stoll(line.substr(0, comma)));
+            trace.values.push_back(std::stod(line.substr(comma + 1)));
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    if (times.size() < 2)
+    {
+        return false;
+    }
+    trace.step = times[1] - times[0];
+    for (size_t i = 1; i < times.size(); i++)
+    {
+        if (times[i] - times[i - 1] != trace.step)
+        {
+            return false;
+        }
+    }
+    return trace.step > 0;
+}
+
+// samples the trace at the intervals nextInterval returns, rounded up to whole trace
+// steps, and holds each sample over the points it stands for: a rate sample over the
+// interval it averages, a gauge sample until the next one
+template <typename F>
+Result replay(const Trace& trace, F nextInterval)
+{
+    size_t count = trace.values.size();
+    std::vector<double> reconstructed(count);
+
+    Result result;
+    size_t previous = 0;
+    size_t current = 0;
+    while (current < count)
+    {
+        double value = trace.values[current];
+        if (trace.rate && current > previous)
+        {
+            value = 0.0;
+            for (size_t i = previous + 1; i <= current; i++)
+            {
+                value += trace.values[i];
+            }
+            value /= static_cast<double>(current - previous);
+        }
+        result.samples++;
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(nextInterval(value)).count();
+        size_t steps = static_cast<size_t>(std::max<long long>((ms + trace.step - 1) / trace.step, 1));
+        size_t next = std::min(current + steps, count);
+
+        if (trace.rate)
+        {
+            std::fill(reconstructed.begin() + static_cast<ptrdiff_t>(current == previous ? current : previous + 1),
+                      reconstructed.begin() + static_cast<ptrdiff_t>(current + 1), value);
+        }
+        else
+        {
+            std::fill(reconstructed.begin() + static_cast<ptrdiff_t>(current),
+                      reconstructed.begin() + static_cast<ptrdiff_t>(next), value);
+        }
+
+        previous = current;
+        current = next;
+    }
+
+    // a rate interval cut off by the end of the trace has no sample
+    size_t covered = trace.rate ? previous + 1 : count;
+    double squares = 0.0;
+    for (size_t i = 0; i < covered; i++)
+    {
+        double error = std::abs(reconstructed[i] - trace.values[i]);
+        squares += error * error;
+        result.maxError = std::max(result.maxError, error);
+    }
+    result.rmse = std::sqrt(squares / static_cast<double>(covered));
+    return result;
+}
+}
+
+int main(int argc, char **argv)
+{
+    SamplerConfig config;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if ((arg == "--sample-min" || arg == "--sample-max") && i + 1 < argc)
+        {
+            std::chrono::milliseconds ms{std::atoll(argv[++i])};
+            (arg == "--sample-min" ? config.minInterval : config.maxInterval) = ms;
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty() || config.minInterval.count() <= 0 || config.minInterval > config.maxInterval)
+    {
+        std::fprintf(stderr, "usage: SamplerBench [--sample-min ms] [--sample-max ms] trace.csv...\n");
+        return 1;
+    }
+
+    std::printf("adaptive between %lld and %lld ms, fixed every %lld ms\n",
+                static_cast<long long>(config.minInterval.count()),
+                static_cast<long long>(config.maxInterval.count()),
+                static_cast<long long>(FIXED_INTERVAL.count()));
+
+    std::printf("%-14s %6s %9s %9s %10s %10s %10s %10s\n",
+                "trace", "points", "fixed", "adaptive", "fixed", "adaptive", "fixed", "adaptive");
+    std::printf("%-14s %6s %9s %9s %10s %10s %10s %10s\n",
+                "", "", "samples", "samples", "rmse", "rmse", "max err", "max err");
+
+    for (const std::string& path : paths)
+    {
+        Trace trace;
+        if (!loadTrace(path, trace))
+        {
+            std::fprintf(stderr, "failed to load trace %s\n", path.c_str());
+            return 1;
+        }
+
+        Result fixed = replay(trace, [](double) {
+            return FIXED_INTERVAL;
+        });
+
+        AdaptiveSampler sampler(config);
+        Result adaptive = replay(trace, [&sampler](double value) {
+            return sampler.record(value);
+        });
+
+        std::printf("%-14s %6zu %9zu %9zu %10.3f %10.3f %10.3f %10.3f\n",
+                    trace.name.c_str(), trace.values.size(),
+                    fixed.samples, adaptive.samples,
+                    fixed.rmse, adaptive.rmse,
+                    fixed.maxError, adaptive.maxError);
+    }
+    return 0;
+}
\ No newline at end of file
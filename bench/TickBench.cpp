@@ -0,0 +1,258 @@
+// tick latency against pool size on a synthetic 1024-CPU / 5000-process host.
+// mirrors ResourceMonitor::tick: a per-core pass and a process pass (the
+// ProcessProvider computation, through the same ProcessTable) start together and the
+// tick waits for both.
+//
+// usage: TickBench [ticks]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Executor.h"
+#include "ProcessTable.h"
+#include "Task.h"
+#include "ThreadPool.h"
+
+namespace
+{
+constexpr size_t CPU_COUNT = 1024;
+constexpr size_t PROCESS_COUNT = 5000;
+constexpr size_t CPU_CHUNK_SIZE = 64;
+constexpr size_t WARMUP_TICKS = 20;
+constexpr size_t WORKER_COUNTS[] = {1, 2, 4, 8};
+
+// 100 ns units, like the PDH timestamps
+constexpr uint64_t TICK_TIME = 10'000'000;
+
+uint64_t mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+struct RawItem
+{
+    std::wstring name;
+    uint64_t value = 0;
+};
+
+// raw counter arrays as PDH would return them, advanced by a fixed pseudo-random load
+class SyntheticHost
+{
+public:
+    SyntheticHost()
+    {
+        const wchar_t *names[] = {L"svchost", L"chrome", L"RuntimeBroker", L"conhost", L"dllhost"};
+
+        m_cores.resize(CPU_COUNT);
+        for (size_t i = 0; i < CPU_COUNT; i++)
+        {
+            m_cores[i].name = std::to_wstring(i);
+        }
+
+        m_processes.resize(PROCESS_COUNT);
+        m_pids.resize(PROCESS_COUNT);
+        for (size_t i = 0; i < PROCESS_COUNT; i++)
+        {
+            // duplicate names get a #n suffix, as in the Process object
+            std::wstring name = names[i % std::size(names)];
+            if (i >= std::size(names))
+            {
+                name += L"#" + std::to_wstring(i / std::size(names));
+            }
+            m_processes[i].name = name;
+            m_pids[i].name = name;
+            m_pids[i].value = 4 + 4 * mix(i) % 400'000;
+        }
+    }
+
+    // the collection steps; each provider owns its query, so they run concurrently
+    void collectCores()
+    {
+        m_coreTick++;
+        for (size_t i = 0; i < CPU_COUNT; i++)
+        {
+            m_cores[i].value += mix(m_coreTick * CPU_COUNT + i) % TICK_TIME;
+        }
+    }
+
+    size_t collectProcesses()
+    {
+        m_processTick++;
+        m_timestamp += TICK_TIME;
+        for (size_t i = 0; i < PROCESS_COUNT; i++)
+        {
+            m_processes[i].value += mix(m_processTick * PROCESS_COUNT + i) % (TICK_TIME / 64);
+        }
+        return PROCESS_COUNT;
+    }
+
+    const std::vector<RawItem>& cores() const
+    {
+        return m_cores;
+    }
+
+    const std::vector<RawItem>& processes() const
+    {
+        return m_processes;
+    }
+
+    const std::vector<RawItem>& pids() const
+    {
+        return m_pids;
+    }
+
+    uint64_t timestamp() const
+    {
+        return m_timestamp;
+    }
+
+private:
+    std::vector<RawItem> m_cores;
+    std::vector<RawItem> m_processes;
+    std::vector<RawItem> m_pids;
+    uint64_t m_coreTick = 0;
+    uint64_t m_processTick = 0;
+    uint64_t m_timestamp = 0;
+};
+
+// per-core busy percentage, the widest array a tick has to read besides processes
+class CoreState
+{
+public:
+    CoreState()
+        : m_previous(CPU_COUNT), m_usage(CPU_COUNT)
+    {
+    }
+
+    Task update(Executor& executor, ThreadPool& pool, SyntheticHost& host)
+    {
+        co_await executor.offload(pool, [&host] {
+            host.collectCores();
+            return 0;
+        });
+
+        co_await executor.parallelFor(pool, CPU_COUNT, CPU_CHUNK_SIZE, [this, &host](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++)
+            {
+                uint64_t busy = host.cores()[i].value;
+                m_usage[i] = static_cast<double>(busy - m_previous[i]) / TICK_TIME * 100.0;
+                m_previous[i] = busy;
+            }
+        });
+    }
+
+private:
+    std::vector<uint64_t> m_previous;
+    std::vector<double> m_usage;
+};
+
+// the ProcessProvider computation over the synthetic arrays
+class ProcessState
+{
+public:
+    ProcessState()
+        : m_table(static_cast<double>(CPU_COUNT))
+    {
+    }
+
+    Task update(Executor& executor, ThreadPool& pool, SyntheticHost& host)
+    {
+        size_t itemCount = co_await executor.offload(pool, [this, &host] {
+            size_t count = host.collectProcesses();
+            m_table.beginCollection(count, host.timestamp());
+            return count;
+        });
+
+        co_await executor.parallelFor(pool, itemCount, ProcessTable::CHUNK_SIZE, [this, &host](size_t begin, size_t end, size_t chunk) {
+            m_table.computeChunk(begin, end, chunk, [&host](size_t i) {
+                return ProcessReading{
+                    .name = host.processes()[i].name.c_str(),
+                    .pidName = host.pids()[i].name.c_str(),
+                    .pid = static_cast<uint32_t>(host.pids()[i].value),
+                    .cpuTime = host.processes()[i].value,
+                };
+            });
+        });
+
+        m_top = m_table.busiest();
+    }
+
+private:
+    ProcessTable m_table;
+    std::optional<ProcessUsage> m_top;
+};
+
+double percentile(std::vector<double> values, double p)
+{
+    std::ranges::sort(values);
+    size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+    return values[index];
+}
+}
+
+int main(int argc, char **argv)
+{
+    size_t ticks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+    if (ticks == 0)
+    {
+        std::fprintf(stderr, "usage: TickBench [ticks]\n");
+        return 1;
+    }
+
+    std::printf("%zu CPUs, %zu processes, %zu ticks, %u hardware threads\n",
+                CPU_COUNT, PROCESS_COUNT, ticks, std::thread::hardware_concurrency());
+    std::printf("%8s %12s %12s %12s %8s\n", "workers", "median us", "p90 us", "max us", "speedup");
+
+    double baseline = 0.0;
+    for (size_t workers : WORKER_COUNTS)
+    {
+        SyntheticHost host;
+        CoreState cores;
+        ProcessState processes;
+        Executor executor;
+        ThreadPool pool(workers);
+
+        std::vector<double> latencies;
+        latencies.reserve(ticks);
+        for (size_t i = 0; i < WARMUP_TICKS + ticks; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            Task coreTask = cores.update(executor, pool, host);
+            Task processTask = processes.update(executor, pool, host);
+            coreTask.start();
+            processTask.start();
+            executor.runUntil(start + std::chrono::minutes(1), [&] {
+                return coreTask.done() && processTask.done();
+            });
+
+            auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+            if (i >= WARMUP_TICKS)
+            {
+                latencies.push_back(elapsed.count());
+            }
+        }
+
+        double median = percentile(latencies, 0.5);
+        if (baseline == 0.0)
+        {
+            baseline = median;
+        }
+        std::printf("%8zu %12.1f %12.1f %12.1f %7.2fx\n",
+                    pool.workerCount(), median, percentile(latencies, 0.9),
+                    *std::ranges::max_element(latencies), baseline / median);
+    }
+    return 0;
+}
\ No newline at end of file
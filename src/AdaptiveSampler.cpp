@@ -0,0 +1,61 @@
+#include "AdaptiveSampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// how much a sample flagged as movement still feeds the noise estimate
+constexpr double BURST_ALPHA_SCALE = 0.1;
+// keeps a metric that has been exactly constant from treating any change as noise-free
+constexpr double MIN_TOLERANCE = 1e-9;
+}
+
+AdaptiveSampler::AdaptiveSampler(const SamplerConfig& config)
+    : m_config(config), m_interval(config.minInterval)
+{
+}
+
+AdaptiveSampler::Clock::duration AdaptiveSampler::record(double value)
+{
+    if (!m_hasSample)
+    {
+        m_hasSample = true;
+        m_previous = value;
+        m_mean = value;
+        m_changeVariance = 0.0;
+        m_moving = true;
+        m_interval = m_config.minInterval;
+        return m_interval;
+    }
+
+    // a change is movement when it stands out from the usual sample-to-sample noise
+    // and is not negligible next to the value itself
+    double change = value - m_previous;
+    double tolerance = std::max({
+        m_config.deviations * std::sqrt(m_changeVariance),
+        m_config.relativeTolerance * std::abs(m_mean),
+        MIN_TOLERANCE,
+    });
+    m_moving = std::abs(change) > tolerance;
+
+    // during a burst the jumps are signal, not noise. they feed the noise estimate
+    // clipped and slowly, so the sampler does not talk itself out of a burst but still
+    // adapts when a metric becomes permanently noisier
+    double alpha = m_moving ? m_config.alpha * BURST_ALPHA_SCALE : m_config.alpha;
+    double noise = std::min(std::abs(change), tolerance);
+    m_changeVariance = (1.0 - alpha) * m_changeVariance + alpha * noise * noise;
+    m_mean += m_config.alpha * (value - m_mean);
+    m_previous = value;
+
+    if (m_moving)
+    {
+        m_interval = m_config.minInterval;
+    }
+    else
+    {
+        auto grown = std::chrono::duration_cast<Clock::duration>(m_interval * m_config.backoff);
+        m_interval = std::min<Clock::duration>(grown, m_config.maxInterval);
+    }
+    return m_interval;
+}
@@ -0,0 +1,53 @@
+#ifndef SRC_ADAPTIVESAMPLER_H
+#define SRC_ADAPTIVESAMPLER_H
+
+#include <chrono>
+
+struct SamplerConfig
+{
+    std::chrono::milliseconds minInterval{250};
+    std::chrono::milliseconds maxInterval{2000};
+
+    // interval growth per stable sample
+    double backoff = 1.5;
+    // weight of the newest sample in the running mean and change variance
+    double alpha = 0.2;
+    // a change counts as movement when it exceeds this many standard deviations of the
+    // usual sample-to-sample change...
+    double deviations = 3.0;
+    // ...and this fraction of the running mean, so small wobbles on a large value are ignored
+    double relativeTolerance = 0.05;
+};
+
+// picks the next sampling interval of one metric from the variance of its recent
+// changes: back off towards maxInterval while the value is stable, drop straight to
+// minInterval as soon as it starts moving.
+class AdaptiveSampler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit AdaptiveSampler(const SamplerConfig& config = {});
+
+    // records a sample and returns how long to wait before the next one
+    Clock::duration record(double value);
+
+    bool moving() const
+    {
+        return m_moving;
+    }
+
+private:
+    SamplerConfig m_config;
+
+    bool m_hasSample = false;
+    double m_previous = 0.0;
+    double m_mean = 0.0;
+    double m_changeVariance = 0.0;
+    bool m_moving = true;
+
+    Clock::duration m_interval;
+};
+
+
+#endif //SRC_ADAPTIVESAMPLER_H
\ No newline at end of file
@@ -2,13 +2,85 @@
 
 #include <array>
 #include <chrono>
+#include <cstdlib>
 #include <format>
+#include <iostream>
+#include <span>
 
 #define MAIN_TIMER 1
+#define SAMPLE_TIMER 2
+#define WM_APP_EXECUTOR (WM_APP + 1)
+#define WM_APP_STARTUP (WM_APP + 2)
+#define WM_APP_FLEET (WM_APP + 3)
+#define WM_APP_GLYPHS (WM_APP + 4)
 
-App::App()
+namespace
+{
+// report the startup trace even if some metric never becomes valid
+constexpr double STARTUP_TRACE_TIMEOUT_MS = 10000.0;
+}
+
+App::App(const Options& options)
     : m_hwnd(nullptr)
 {
+    m_sampling.minInterval = options.sampleMin;
+    m_sampling.maxInterval = options.sampleMax;
+
+    if (options.publishTarget)
+    {
+        m_publisher = std::make_unique<FleetPublisher>(*options.publishTarget, options.hostName);
+    }
+    if (options.aggregatePort)
+    {
+        m_aggregator = std::make_unique<FleetAggregator>(*options.aggregatePort);
+    }
+
+    std::span<const LayoutElement> layout = options.aggregatePort
+        ? std::span<const LayoutElement>(FLEET_LAYOUT)
+        : std::span<const LayoutElement>(DEFAULT_LAYOUT);
+
+    m_dwriteEngineFuture = std::async(std::launch::async, [this, layout] {
+        std::unique_ptr<DWriteEngine> engine;
+        {
+            auto phase = m_trace.phase(L"text formats");
+            engine = std::make_unique<DWriteEngine>(layout, [this] {
+                // called from the glyph loader thread; the atlas is adopted on the UI thread
+                if (HWND hwnd = m_notifyHwnd.load())
+                {
+                    PostMessage(hwnd, WM_APP_GLYPHS, 0, 0);
+                }
+            });
+        }
+
+        // the window opens on the primary monitor, which has the system DPI; a window
+        // that turns out elsewhere reloads the atlas on its first resize. the first
+        // frames do not wait for it
+        engine->loadGlyphCache(static_cast<float>(GetDpiForSystem()), &m_trace);
+        return engine;
+    });
+
+    m_resourceMonitorFuture = std::async(std::launch::async, [this] {
+        std::unique_ptr<ResourceMonitor> monitor;
+        {
+            auto phase = m_trace.phase(L"counters");
+            monitor = std::make_unique<ResourceMonitor>([this] {
+                // called from pool threads; the continuation runs on the UI thread
+                if (HWND hwnd = m_notifyHwnd.load())
+                {
+                    PostMessage(hwnd, WM_APP_EXECUTOR, 0, 0);
+                }
+            }, m_sampling);
+        }
+        // a window created later adopts the monitor in run()
+        if (HWND hwnd = m_notifyHwnd.load())
+        {
+            PostMessage(hwnd, WM_APP_STARTUP, 0, 0);
+        }
+        return monitor;
+    });
+
+    auto phase = m_trace.phase(L"register class");
+
     WNDCLASSEX wc = {
         .cbSize = sizeof(WNDCLASSEX),
         .style = CS_HREDRAW | CS_VREDRAW,
@@ -21,12 +93,11 @@ App::App()
     };
 
     RegisterClassEx(&wc);
-
-    m_resourceMonitor = std::make_unique<ResourceMonitor>();
 }
 
 App::~App()
 {
+    m_notifyHwnd = nullptr;
     if (m_hwnd)
     {
         DestroyWindow(m_hwnd);
@@ -38,6 +109,8 @@ App::~App()
 
 int App::createWindow(int width, int height)
 {
+    auto phase = m_trace.phase(L"create window");
+
     HWND hwnd = CreateWindowEx(
         WS_EX_LAYERED | WS_EX_TOOLWINDOW,
         className,
@@ -58,26 +131,64 @@ int App::createWindow(int width, int height)
     RECT windowRect;
     SystemParametersInfo(SPI_GETWORKAREA, 0, &windowRect, 0);
 
-    constexpr int margin = 20;
-    int x = windowRect.right - width - margin;
+    // width, height and margin are in DIPs; the window is per-monitor DPI aware
+    UINT dpi = GetDpiForWindow(hwnd);
+    int scaledWidth = MulDiv(width, static_cast<int>(dpi), 96);
+    int scaledHeight = MulDiv(height, static_cast<int>(dpi), 96);
+    int margin = MulDiv(20, static_cast<int>(dpi), 96);
+    int x = windowRect.right - scaledWidth - margin;
     int y = windowRect.top;
-    SetWindowPos(hwnd, nullptr, x, y, 0, 0, SWP_NOSIZE | SWP_NOZORDER);
+    SetWindowPos(hwnd, nullptr, x, y, scaledWidth, scaledHeight, SWP_NOZORDER);
+
+    if (m_aggregator)
+    {
+        m_aggregator->attach(hwnd, WM_APP_FLEET);
+    }
 
     return 0;
 }
 
 void App::initD2D()
 {
-    HRESULT hr = D2D1CreateFactory(
-        D2D1_FACTORY_TYPE_SINGLE_THREADED,
-        m_d2dFactory.GetAddressOf()
-    );
+    HRESULT hr;
+    {
+        auto phase = m_trace.phase(L"d2d factory");
+        hr = D2D1CreateFactory(
+            D2D1_FACTORY_TYPE_SINGLE_THREADED,
+            m_d2dFactory.GetAddressOf()
+        );
+    }
     if (FAILED(hr))
     {
         MessageBox(nullptr, L"Failed to create D2D factory", L"Error", MB_OK | MB_ICONERROR);
         return;
     }
 
+    std::array<wchar_t, 16> faultInterval = {};
+    if (GetEnvironmentVariable(FAULT_INJECTION_ENV, faultInterval.data(), static_cast<DWORD>(faultInterval.size())) > 0)
+    {
+        m_faultInterval = _wtoi(faultInterval.data());
+    }
+
+    {
+        auto phase = m_trace.phase(L"device resources");
+        hr = createDeviceResources();
+    }
+    if (FAILED(hr))
+    {
+        MessageBox(nullptr, L"Failed to create device resources", L"Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+}
+
+void App::injectDeviceLost()
+{
+    m_injectDeviceLost = true;
+    InvalidateRect(m_hwnd, nullptr, FALSE);
+}
+
+HRESULT App::createDeviceResources()
+{
     RECT rc;
     GetClientRect(m_hwnd, &rc);
 
@@ -97,7 +208,7 @@ void App::initD2D()
 
     Microsoft::WRL::ComPtr<ID3D11Device> d3dDevice;
     Microsoft::WRL::ComPtr<ID3D11DeviceContext> d3dContext;
-    hr = D3D11CreateDevice(
+    HRESULT hr = D3D11CreateDevice(
         nullptr, // Use default adapter
         D3D_DRIVER_TYPE_HARDWARE,
         nullptr, // No software device
@@ -110,23 +221,23 @@ void App::initD2D()
     );
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to create D3D11 device", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to create D3D11 device" << std::endl;
+        return hr;
     }
 
     Microsoft::WRL::ComPtr<IDXGIDevice> dxgiDevice;
     hr = d3dDevice.As(&dxgiDevice);
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to get IDXGIDevice", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to get IDXGIDevice" << std::endl;
+        return hr;
     }
 
     hr = m_d2dFactory->CreateDevice(dxgiDevice.Get(), &m_d2dDevice);
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to create D2D device", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to create D2D device" << std::endl;
+        return hr;
     }
 
     hr = m_d2dDevice->CreateDeviceContext(
@@ -135,8 +246,9 @@ void App::initD2D()
     );
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to create D2D device context", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to create D2D device context" << std::endl;
+        discardDeviceResources();
+        return hr;
     }
 
     DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {
@@ -156,16 +268,18 @@ void App::initD2D()
     hr = dxgiDevice->GetAdapter(&dxgiAdapter);
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to get DXGI adapter", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to get DXGI adapter" << std::endl;
+        discardDeviceResources();
+        return hr;
     }
 
     Microsoft::WRL::ComPtr<IDXGIFactory2> dxgiFactory;
     hr = dxgiAdapter->GetParent(IID_PPV_ARGS(&dxgiFactory));
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to get DXGI factory", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to get DXGI factory" << std::endl;
+        discardDeviceResources();
+        return hr;
     }
 
     hr = dxgiFactory->CreateSwapChainForHwnd(
@@ -178,13 +292,112 @@ void App::initD2D()
     );
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to create swap chain", L"Error", MB_OK | MB_ICONERROR);
+        std::cerr << "Failed to create swap chain" << std::endl;
+        discardDeviceResources();
+        return hr;
+    }
+
+    hr = createSurfaceBitmap();
+    if (FAILED(hr))
+    {
+        discardDeviceResources();
+        return hr;
+    }
+
+    // the engine may still be loading fonts on the startup thread; it picks the context up then
+    if (m_dwriteEngine)
+    {
+        hr = m_dwriteEngine->createDeviceResources(m_d2dContext);
+        if (FAILED(hr))
+        {
+            discardDeviceResources();
+            return hr;
+        }
+    }
+
+    return S_OK;
+}
+
+void App::discardDeviceResources()
+{
+    if (m_dwriteEngine)
+    {
+        m_dwriteEngine->releaseDeviceResources();
+    }
+
+    if (m_d2dContext)
+    {
+        m_d2dContext->SetTarget(nullptr);
+    }
+    m_bitmap.Reset();
+    // a flip-model swap chain must be released before another one can bind to the window
+    m_swapChain.Reset();
+    m_d2dContext.Reset();
+    m_d2dDevice.Reset();
+}
+
+void App::handleDeviceLost()
+{
+    if (!m_deviceLost)
+    {
+        m_deviceLost = true;
+        m_deviceLostAt = std::chrono::steady_clock::now();
+    }
+
+    // text formats and provider history survive; only the device-bound set is dropped
+    discardDeviceResources();
+    InvalidateRect(m_hwnd, nullptr, FALSE);
+}
+
+void App::ensureDWriteEngine()
+{
+    if (m_dwriteEngine)
+    {
+        return;
+    }
+
+    // the clock cannot be drawn without fonts, so this is the one place startup may wait
+    m_dwriteEngine = m_dwriteEngineFuture.get();
+
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    m_dwriteEngine->resize(SIZE{rc.right - rc.left, rc.bottom - rc.top}, windowDpi());
+
+    if (m_d2dContext && FAILED(m_dwriteEngine->createDeviceResources(m_d2dContext)))
+    {
+        discardDeviceResources();
+    }
+
+    // a load that finished before the window existed had no one to notify
+    m_dwriteEngine->adoptGlyphCache();
+}
+
+void App::adoptResourceMonitor()
+{
+    if (m_resourceMonitor || !m_resourceMonitorFuture.valid())
+    {
+        return;
+    }
+    if (m_resourceMonitorFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
         return;
     }
 
-    createSurfaceBitmap();
+    try
+    {
+        m_resourceMonitor = m_resourceMonitorFuture.get();
+    }
+    catch (const std::exception& e)
+    {
+        // keep drawing placeholders rather than taking the clock down
+        std::cerr << "failed to create resource monitor: " << e.what() << std::endl;
+        return;
+    }
 
-    m_dwriteEngine = std::make_unique<DWriteEngine>(m_d2dContext, rc);
+    // first sample now; each provider asks for its next one after the shortest
+    // interval, so rates become valid quickly
+    m_resourceMonitor->tick();
+    SetTimer(m_hwnd, SAMPLE_TIMER, static_cast<UINT>(m_sampling.minInterval.count()), nullptr);
 }
 
 void App::run()
@@ -192,6 +405,8 @@ void App::run()
     ShowWindow(m_hwnd, SW_SHOW);
     UpdateWindow(m_hwnd);
 
+    adoptResourceMonitor();
+
     SetTimer(m_hwnd, MAIN_TIMER, 1000, nullptr);
     SetWindowPos(m_hwnd, HWND_BOTTOM, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
 
@@ -216,6 +431,7 @@ LRESULT App::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         SetLayeredWindowAttributes(hwnd, RGB(255, 255, 255), 0, LWA_COLORKEY);
 
         app->m_hwnd = hwnd;
+        app->m_notifyHwnd = hwnd;
     }
     else
     {
@@ -246,10 +462,58 @@ LRESULT App::handleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
         onResize();
         return 0;
 
+    case WM_DPICHANGED:
+        onDpiChanged(*reinterpret_cast<const RECT *>(lParam));
+        return 0;
+
+    case WM_APP_EXECUTOR:
+        if (m_resourceMonitor && m_resourceMonitor->runReady())
+        {
+            InvalidateRect(m_hwnd, nullptr, FALSE);
+        }
+        return 0;
+
+    case WM_APP_FLEET:
+        // frames are applied as they arrive; the grid repaints with the clock
+        if (m_aggregator)
+        {
+            m_aggregator->receive();
+        }
+        return 0;
+
+    case WM_APP_GLYPHS:
+        // the timer switches from DrawText to the atlas with the next frame
+        if (m_dwriteEngine && m_dwriteEngine->adoptGlyphCache())
+        {
+            InvalidateRect(m_hwnd, nullptr, FALSE);
+        }
+        return 0;
+
+    case WM_APP_STARTUP:
+        adoptResourceMonitor();
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+        return 0;
+
     case WM_TIMER:
+        // only providers whose sampler says they are due are started; repaint between
+        // clock seconds only if one of them produced something new
+        if (wParam == SAMPLE_TIMER && m_resourceMonitor && m_resourceMonitor->tick())
+        {
+            InvalidateRect(m_hwnd, nullptr, FALSE);
+        }
         if (wParam == MAIN_TIMER)
         {
+            adoptResourceMonitor();
+            if (m_resourceMonitor && m_publisher)
+            {
+                m_publisher->publish(m_resourceMonitor->snapshot());
+            }
             InvalidateRect(m_hwnd, nullptr, FALSE);
+
+            if (m_trace.elapsedMs() > STARTUP_TRACE_TIMEOUT_MS)
+            {
+                m_trace.report();
+            }
         }
 
     default:
@@ -262,31 +526,77 @@ void App::onPaint()
     PAINTSTRUCT ps;
     BeginPaint(m_hwnd, &ps);
 
+    ensureDWriteEngine();
+
+    // recreated lazily after a device loss, in the same frame that needs it
+    if (!m_d2dContext && FAILED(createDeviceResources()))
+    {
+        // the adapter may still be resetting; the next timer tick retries
+        EndPaint(m_hwnd, &ps);
+        return;
+    }
+
+    if (m_faultInterval > 0 && ++m_framesSinceFault >= m_faultInterval)
+    {
+        m_framesSinceFault = 0;
+        m_injectDeviceLost = true;
+    }
+
     m_d2dContext->BeginDraw();
     m_d2dContext->Clear(D2D1::ColorF(1, 1, 1));
 
-    m_dwriteEngine->draw(createDrawInfo());
+    m_dwriteEngine->draw(
+        createDrawInfo(),
+        m_resourceMonitor ? &m_resourceMonitor->cpuHistory() : nullptr,
+        m_aggregator ? &m_aggregator->hosts() : nullptr
+    );
 
-    if (FAILED(m_d2dContext->EndDraw()))
+    HRESULT hr = m_d2dContext->EndDraw();
+    if (m_injectDeviceLost)
     {
-        m_d2dContext.Reset();
+        m_injectDeviceLost = false;
+        hr = D2DERR_RECREATE_TARGET;
     }
 
-    m_swapChain->Present(1, 0);
+    if (SUCCEEDED(hr))
+    {
+        hr = m_swapChain->Present(1, 0);
+    }
+
+    if (hr == D2DERR_RECREATE_TARGET || hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+    {
+        handleDeviceLost();
+    }
+    else if (SUCCEEDED(hr))
+    {
+        m_trace.firstFrame();
+    }
+
+    if (SUCCEEDED(hr) && m_deviceLost)
+    {
+        m_deviceLost = false;
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_deviceLostAt);
+        std::cerr << std::format("recovered from device loss in {:.2f} ms", elapsed.count() / 1000.0) << std::endl;
+    }
 
     EndPaint(m_hwnd, &ps);
 }
 
 void App::onResize()
 {
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+
+    if (m_dwriteEngine)
+    {
+        m_dwriteEngine->resize(SIZE{rc.right - rc.left, rc.bottom - rc.top}, windowDpi());
+    }
+
     if (!m_d2dContext)
     {
         return;
     }
 
-    RECT rc;
-    GetClientRect(m_hwnd, &rc);
-
     D2D1_SIZE_U size = D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top);
 
     m_d2dContext->SetTarget(nullptr);
@@ -298,49 +608,92 @@ void App::onResize()
         DXGI_FORMAT_B8G8R8A8_UNORM,
         0 // No additional flags
     );
+    if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+    {
+        handleDeviceLost();
+        return;
+    }
     if (FAILED(hr))
     {
         MessageBox(nullptr, L"Failed to resize swap chain buffers", L"Error", MB_OK | MB_ICONERROR);
         return;
     }
 
-    createSurfaceBitmap();
+    if (FAILED(createSurfaceBitmap()))
+    {
+        handleDeviceLost();
+        return;
+    }
 
     InvalidateRect(m_hwnd, nullptr, FALSE);
 }
 
-void App::createSurfaceBitmap()
+void App::onDpiChanged(const RECT& suggested)
+{
+    // moving to a monitor with another DPI: take the size Windows suggests. a new size
+    // arrives as WM_SIZE; otherwise the layout, glyph atlas and surface DPI are redone here
+    RECT current;
+    GetWindowRect(m_hwnd, &current);
+    bool sameSize = current.right - current.left == suggested.right - suggested.left
+        && current.bottom - current.top == suggested.bottom - suggested.top;
+
+    SetWindowPos(
+        m_hwnd,
+        nullptr,
+        suggested.left,
+        suggested.top,
+        suggested.right - suggested.left,
+        suggested.bottom - suggested.top,
+        SWP_NOZORDER | SWP_NOACTIVATE
+    );
+    if (sameSize)
+    {
+        onResize();
+    }
+}
+
+float App::windowDpi() const
+{
+    return static_cast<float>(GetDpiForWindow(m_hwnd));
+}
+
+HRESULT App::createSurfaceBitmap()
 {
     Microsoft::WRL::ComPtr<IDXGISurface> dxgiSurface;
     HRESULT hr = m_swapChain->GetBuffer(0, IID_PPV_ARGS(&dxgiSurface));
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to get DXGI surface", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to get DXGI surface" << std::endl;
+        return hr;
     }
 
+    // drawing stays in DIPs; the context scales it to the monitor the window is on
+    float dpi = windowDpi();
     hr = m_d2dContext->CreateBitmapFromDxgiSurface(
         dxgiSurface.Get(),
         D2D1::BitmapProperties1(
             D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
             D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
-            96.0f, // Default DPI
-            96.0f  // Default DPI
+            dpi,
+            dpi
         ),
         &m_bitmap
     );
     if (FAILED(hr))
     {
-        MessageBox(nullptr, L"Failed to create D2D bitmap from DXGI surface", L"Error", MB_OK | MB_ICONERROR);
-        return;
+        std::cerr << "Failed to create D2D bitmap from DXGI surface" << std::endl;
+        return hr;
     }
 
     m_d2dContext->SetTarget(m_bitmap.Get());
+    m_d2dContext->SetDpi(dpi, dpi);
+    return S_OK;
 }
 
 DrawInfo App::createDrawInfo()
 {
-    DrawInfo info = m_resourceMonitor->collect();
+    DrawInfo info = m_resourceMonitor ? m_resourceMonitor->snapshot() : ResourceMonitor::placeholderSnapshot();
+    traceFirstValidMetrics(info);
 
     using namespace std::chrono;
     auto now = zoned_time{
@@ -351,3 +704,32 @@ DrawInfo App::createDrawInfo()
     info.timeString = std::format(L"{:%H:%M:%S}", now);
     return info;
 }
+
+void App::traceFirstValidMetrics(const DrawInfo& info)
+{
+    const std::array<std::pair<const wchar_t *, const MetricValue *>, 5> metrics = {{
+        {L"cpu", &info.cpuUsage},
+        {L"memory", &info.memoryUsage},
+        {L"network", &info.networkUsage},
+        {L"disk", &info.diskUsage},
+        {L"process", &info.topProcess},
+    }};
+
+    bool allValid = true;
+    for (const auto& [name, metric] : metrics)
+    {
+        if (metric->valid)
+        {
+            m_trace.firstValidMetric(name);
+        }
+        else
+        {
+            allValid = false;
+        }
+    }
+
+    if (allValid)
+    {
+        m_trace.report();
+    }
+}
@@ -7,16 +7,22 @@
 #include <dxgi1_6.h>
 #include <wrl/client.h>
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <memory>
 
 #include "DWriteEngine.h"
 #include "DrawInfo.h"
+#include "Fleet.h"
+#include "Options.h"
 #include "ResourceMonitor.h"
+#include "StartupTrace.h"
 
 class App
 {
 public:
-    App();
+    explicit App(const Options& options);
     ~App();
 
     // create top right
@@ -28,18 +34,39 @@ public:
     void initD2D();
     void run();
 
+    // fault-injection hook: the next frame behaves as if the GPU device was lost
+    void injectDeviceLost();
+
 private:
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
     LRESULT handleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam);
 
     void onPaint();
     void onResize();
+    void onDpiChanged(const RECT& suggested);
+
+    float windowDpi() const;
+
+    // swap chain, D2D device/context, target bitmap and brushes
+    HRESULT createDeviceResources();
+    void discardDeviceResources();
+    void handleDeviceLost();
 
-    void createSurfaceBitmap();
+    HRESULT createSurfaceBitmap();
+
+    // take over what the startup thread built once it is ready
+    void ensureDWriteEngine();
+    void adoptResourceMonitor();
 
     DrawInfo createDrawInfo();
+    void traceFirstValidMetrics(const DrawInfo& info);
+
+    // first member: everything after it is timed
+    StartupTrace m_trace;
 
     HWND m_hwnd;
+    // m_hwnd for the startup and pool threads, which may run before the window exists
+    std::atomic<HWND> m_notifyHwnd = nullptr;
 
     const wchar_t* className = L"ApplicationWindowClass";
 
@@ -51,6 +78,26 @@ private:
 
     std::unique_ptr<DWriteEngine> m_dwriteEngine;
     std::unique_ptr<ResourceMonitor> m_resourceMonitor;
+
+    // per-metric sampling bounds; the sample timer runs at the fastest of them
+    SamplerConfig m_sampling;
+
+    std::unique_ptr<FleetPublisher> m_publisher;
+    std::unique_ptr<FleetAggregator> m_aggregator;
+
+    // counter setup and font loading run concurrently with window and device creation
+    std::future<std::unique_ptr<DWriteEngine>> m_dwriteEngineFuture;
+    std::future<std::unique_ptr<ResourceMonitor>> m_resourceMonitorFuture;
+
+    bool m_deviceLost = false;
+    std::chrono::steady_clock::time_point m_deviceLostAt;
+
+    bool m_injectDeviceLost = false;
+    // > 0: inject a device loss every n frames
+    int m_faultInterval = 0;
+    int m_framesSinceFault = 0;
+
+    const wchar_t *FAULT_INJECTION_ENV = L"CLOCKAPP_INJECT_DEVICE_LOST";
 };
 
 
@@ -1,10 +1,28 @@
 #include "DWriteEngine.h"
 
+#include <algorithm>
+#include <cmath>
+#include <format>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
 
-DWriteEngine::DWriteEngine(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& target, RECT rc)
-    : m_renderTarget(target), m_rect(rc)
+#include "Fleet.h"
+#include "MetricHistory.h"
+#include "StartupTrace.h"
+
+namespace
+{
+// elements the layout leaves out still get a format, at the built-in size
+float layoutFontSize(std::span<const LayoutElement> layout, Element element, float fallback)
+{
+    auto it = std::ranges::find(layout, element, &LayoutElement::element);
+    return it != layout.end() && it->fontSize > 0.0f ? it->fontSize : fallback;
+}
+}
+
+DWriteEngine::DWriteEngine(std::span<const LayoutElement> layout, std::function<void()> glyphCacheReady)
+    : m_layout(layout), m_glyphCacheReady(std::move(glyphCacheReady))
 {
     HRESULT hr = DWriteCreateFactory(
         DWRITE_FACTORY_TYPE_SHARED,
@@ -23,7 +41,7 @@ DWriteEngine::DWriteEngine(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& targ
         DWRITE_FONT_WEIGHT_BOLD,
         DWRITE_FONT_STYLE_NORMAL,
         DWRITE_FONT_STRETCH_NORMAL,
-        FONT_SIZE_TIMER,
+        layoutFontSize(layout, Element::TIMER, FONT_SIZE_TIMER),
         LOCALE.c_str(),
         &m_formatTimer
     );
@@ -53,7 +71,7 @@ DWriteEngine::DWriteEngine(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& targ
         DWRITE_FONT_WEIGHT_NORMAL,
         DWRITE_FONT_STYLE_NORMAL,
         DWRITE_FONT_STRETCH_NORMAL,
-        FONT_SIZE_OTHERS,
+        layoutFontSize(layout, Element::CPU, FONT_SIZE_METRIC),
         LOCALE.c_str(),
         &m_formatCPU
     );
@@ -69,7 +87,7 @@ DWriteEngine::DWriteEngine(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& targ
         DWRITE_FONT_WEIGHT_NORMAL,
         DWRITE_FONT_STYLE_NORMAL,
         DWRITE_FONT_STRETCH_NORMAL,
-        FONT_SIZE_OTHERS,
+        layoutFontSize(layout, Element::MEMORY, FONT_SIZE_METRIC),
         LOCALE.c_str(),
         &m_formatMemory
     );
@@ -85,7 +103,7 @@ DWriteEngine::DWriteEngine(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& targ
         DWRITE_FONT_WEIGHT_NORMAL,
         DWRITE_FONT_STYLE_NORMAL,
         DWRITE_FONT_STRETCH_NORMAL,
-        FONT_SIZE_OTHERS,
+        layoutFontSize(layout, Element::NETWORK, FONT_SIZE_METRIC),
         LOCALE.c_str(),
         &m_formatNetwork
     );
@@ -95,54 +113,451 @@ DWriteEngine::DWriteEngine(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& targ
         throw std::runtime_error("failed to create text format");
     }
 
-    hr = m_renderTarget->CreateSolidColorBrush(
+    hr = m_factory->CreateTextFormat(
+        FONT_FAMILY_OTHERS.c_str(),
+        nullptr,
+        DWRITE_FONT_WEIGHT_NORMAL,
+        DWRITE_FONT_STYLE_NORMAL,
+        DWRITE_FONT_STRETCH_NORMAL,
+        layoutFontSize(layout, Element::DISK, FONT_SIZE_METRIC),
+        LOCALE.c_str(),
+        &m_formatDisk
+    );
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create text format for disk" << std::endl;
+        throw std::runtime_error("failed to create text format");
+    }
+
+    hr = m_factory->CreateTextFormat(
+        FONT_FAMILY_OTHERS.c_str(),
+        nullptr,
+        DWRITE_FONT_WEIGHT_NORMAL,
+        DWRITE_FONT_STYLE_NORMAL,
+        DWRITE_FONT_STRETCH_NORMAL,
+        layoutFontSize(layout, Element::DISK_IO, FONT_SIZE_METRIC),
+        LOCALE.c_str(),
+        &m_formatDiskIo
+    );
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create text format for disk io" << std::endl;
+        throw std::runtime_error("failed to create text format");
+    }
+
+    hr = m_factory->CreateTextFormat(
+        FONT_FAMILY_OTHERS.c_str(),
+        nullptr,
+        DWRITE_FONT_WEIGHT_NORMAL,
+        DWRITE_FONT_STYLE_NORMAL,
+        DWRITE_FONT_STRETCH_NORMAL,
+        layoutFontSize(layout, Element::PROCESS, FONT_SIZE_METRIC),
+        LOCALE.c_str(),
+        &m_formatProcess
+    );
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create text format for process" << std::endl;
+        throw std::runtime_error("failed to create text format");
+    }
+
+    hr = m_factory->CreateTextFormat(
+        FONT_FAMILY_OTHERS.c_str(),
+        nullptr,
+        DWRITE_FONT_WEIGHT_NORMAL,
+        DWRITE_FONT_STYLE_NORMAL,
+        DWRITE_FONT_STRETCH_NORMAL,
+        layoutFontSize(layout, Element::FLEET_GRID, FONT_SIZE_FLEET),
+        LOCALE.c_str(),
+        &m_formatFleet
+    );
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create text format for fleet" << std::endl;
+        throw std::runtime_error("failed to create text format");
+    }
+}
+
+void DWriteEngine::resize(SIZE client, float dpi)
+{
+    m_layout.compute(client, dpi);
+
+    // a missing font is not retried on every resize, only when the DPI changes again
+    if (dpi != m_glyphCacheDpi)
+    {
+        loadGlyphCache(dpi);
+    }
+}
+
+void DWriteEngine::loadGlyphCache(float dpi, StartupTrace *trace)
+{
+    m_glyphCacheDpi = dpi;
+    // a load in flight is not cancelled; adoptGlyphCache starts the next one when it ends
+    if (m_glyphCacheFuture.valid())
+    {
+        return;
+    }
+    m_glyphCacheLoadDpi = dpi;
+
+    // a cold build rasterizes, writes and renames the cache file, far too slow for the
+    // UI thread. the task only touches copies, never the engine
+    std::packaged_task<std::unique_ptr<GlyphCache>()> load([
+        factory = m_factory,
+        fontFamily = FONT_FAMILY_TIMER,
+        fontSize = m_formatTimer->GetFontSize(),
+        alphabet = TIMER_ALPHABET,
+        dpi,
+        trace
+    ] {
+        std::optional<StartupTrace::Phase> phase;
+        if (trace)
+        {
+            phase.emplace(*trace, L"glyph cache");
+        }
+
+        std::unique_ptr<GlyphCache> cache;
+        try
+        {
+            cache = std::make_unique<GlyphCache>(
+                factory,
+                fontFamily,
+                DWRITE_FONT_WEIGHT_BOLD,
+                fontSize,
+                dpi,
+                alphabet
+            );
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "glyph cache unavailable: " << e.what() << std::endl;
+        }
+
+        if (phase)
+        {
+            phase->rename(cache && cache->warm() ? L"glyph cache (warm)" : L"glyph cache (cold)");
+        }
+        return cache;
+    });
+    m_glyphCacheFuture = load.get_future();
+
+    // the future is ready before the callback runs, so the adopt it triggers never waits
+    m_glyphCacheLoader = std::jthread([load = std::move(load), ready = m_glyphCacheReady]() mutable {
+        load();
+        if (ready)
+        {
+            ready();
+        }
+    });
+}
+
+bool DWriteEngine::adoptGlyphCache()
+{
+    if (!m_glyphCacheFuture.valid() || m_glyphCacheFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false;
+    }
+
+    std::unique_ptr<GlyphCache> cache = m_glyphCacheFuture.get();
+    if (m_glyphCacheLoadDpi != m_glyphCacheDpi)
+    {
+        // the window moved to another DPI while loading; the timer keeps using DrawText
+        loadGlyphCache(m_glyphCacheDpi);
+        return false;
+    }
+
+    m_glyphCache = std::move(cache);
+    m_glyphAtlas.Reset();
+    if (m_glyphCache && m_renderTarget)
+    {
+        createGlyphAtlas();
+    }
+    return true;
+}
+
+HRESULT DWriteEngine::createGlyphAtlas()
+{
+    if (!m_glyphCache || m_glyphCache->atlasWidth() == 0 || m_glyphCache->atlasHeight() == 0)
+    {
+        return S_FALSE;
+    }
+
+    float dpi = m_glyphCache->dpi();
+    HRESULT hr = m_renderTarget->CreateBitmap(
+        D2D1::SizeU(m_glyphCache->atlasWidth(), m_glyphCache->atlasHeight()),
+        m_glyphCache->atlas(),
+        m_glyphCache->atlasWidth(),
+        D2D1::BitmapProperties(
+            D2D1::PixelFormat(DXGI_FORMAT_A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+            dpi,
+            dpi
+        ),
+        &m_glyphAtlas
+    );
+    if (FAILED(hr))
+    {
+        // not fatal: the timer is drawn with DrawText instead
+        std::cerr << "failed to create glyph atlas bitmap" << std::endl;
+    }
+    return hr;
+}
+
+HRESULT DWriteEngine::createDeviceResources(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& target)
+{
+    HRESULT hr = target->CreateSolidColorBrush(
         D2D1::ColorF(D2D1::ColorF::Black),
         &m_blackBrush
     );
     if (FAILED(hr))
     {
         std::cerr << "failed to create solid color brush" << std::endl;
-        throw std::runtime_error("failed to create solid color brush");
+        return hr;
+    }
+
+    hr = target->CreateSolidColorBrush(
+        D2D1::ColorF(D2D1::ColorF::Gray),
+        &m_grayBrush
+    );
+    if (FAILED(hr))
+    {
+        std::cerr << "failed to create solid color brush" << std::endl;
+        m_blackBrush.Reset();
+        return hr;
+    }
+
+    m_renderTarget = target;
+    createGlyphAtlas();
+    return S_OK;
+}
+
+void DWriteEngine::releaseDeviceResources()
+{
+    m_renderTarget.Reset();
+    m_blackBrush.Reset();
+    m_grayBrush.Reset();
+    m_glyphAtlas.Reset();
+}
+
+ID2D1SolidColorBrush *DWriteEngine::metricBrush(const MetricValue& metric) const
+{
+    return metric.stale || !metric.valid ? m_grayBrush.Get() : m_blackBrush.Get();
+}
+
+void DWriteEngine::draw(const DrawInfo& info, const MetricHistory *cpuHistory, const std::vector<FleetHost> *fleet) const
+{
+    for (const PlacedElement& placed : m_layout.elements())
+    {
+        switch (placed.element)
+        {
+        case Element::TIMER:
+            drawTimer(info.timeString, placed.rect);
+            break;
+        case Element::CPU:
+            drawMetric(info.cpuUsage, m_formatCPU.Get(), placed.rect);
+            break;
+        case Element::MEMORY:
+            drawMetric(info.memoryUsage, m_formatMemory.Get(), placed.rect);
+            break;
+        case Element::NETWORK:
+            drawMetric(info.networkUsage, m_formatNetwork.Get(), placed.rect);
+            break;
+        case Element::DISK:
+            drawMetric(info.diskUsage, m_formatDisk.Get(), placed.rect);
+            break;
+        case Element::DISK_IO:
+            drawMetric(info.diskIo, m_formatDiskIo.Get(), placed.rect);
+            break;
+        case Element::PROCESS:
+            drawMetric(info.topProcess, m_formatProcess.Get(), placed.rect);
+            break;
+        case Element::CPU_GRAPH:
+            if (cpuHistory)
+            {
+                drawHistory(*cpuHistory, 100.0, placed.rect);
+            }
+            break;
+        case Element::FLEET_GRID:
+            if (fleet)
+            {
+                drawFleet(*fleet);
+            }
+            break;
+        }
     }
 }
 
-void DWriteEngine::draw(const DrawInfo& info) const
+void DWriteEngine::drawTimer(const std::wstring& text, const D2D1_RECT_F& rect) const
 {
+    if (drawTimerGlyphs(text, rect))
+    {
+        return;
+    }
+
     m_renderTarget->DrawText(
-        info.timeString.c_str(),
-        info.timeString.size(),
+        text.c_str(),
+        static_cast<UINT32>(text.size()),
         m_formatTimer.Get(),
-        D2D1::RectF(0, 0, static_cast<FLOAT>(m_rect.right - m_rect.left), static_cast<FLOAT>(m_rect.bottom - m_rect.top)),
+        rect,
         m_blackBrush.Get()
     );
+}
+
+bool DWriteEngine::drawTimerGlyphs(const std::wstring& text, const D2D1_RECT_F& rect) const
+{
+    if (!m_glyphAtlas || m_glyphCache->dpi() != m_layout.dpi())
+    {
+        return false;
+    }
 
-    constexpr float pfWidth = 280.0f;
-    float pfHeight = FONT_SIZE_OTHERS * 1.2f;
-    float pfHeightBase = FONT_SIZE_TIMER * 1.3f;
-    float pfLeft = static_cast<float>(m_rect.right - m_rect.left) - pfWidth;
-    float pfRight = pfLeft + pfWidth;
+    float textWidth = 0.0f;
+    for (wchar_t ch : text)
+    {
+        const CachedGlyph *glyph = m_glyphCache->find(ch);
+        if (!glyph)
+        {
+            return false;
+        }
+        textWidth += glyph->advance;
+    }
 
-    m_renderTarget->DrawText(
-        info.cpuUsage.c_str(),
-        info.cpuUsage.size(),
-        m_formatCPU.Get(),
-        D2D1::RectF(pfLeft, pfHeightBase, pfRight, pfHeightBase + pfHeight),
-        m_blackBrush.Get()
-    );
+    // lay out in atlas pixels, right-aligned like m_formatTimer, with every glyph
+    // origin on a whole pixel as it was when rasterized
+    float pixelsPerDip = m_glyphCache->dpi() / 96.0f;
+    auto dip = [pixelsPerDip](float px) {
+        return px / pixelsPerDip;
+    };
+    float pen = std::floor(rect.right * pixelsPerDip - textWidth);
+    float baseline = std::round(rect.top * pixelsPerDip + m_glyphCache->ascent());
 
-    m_renderTarget->DrawText(
-        info.memoryUsage.c_str(),
-        info.memoryUsage.size(),
-        m_formatMemory.Get(),
-        D2D1::RectF(pfLeft, pfHeightBase + pfHeight, pfRight, pfHeightBase + pfHeight * 2),
-        m_blackBrush.Get()
-    );
+    // FillOpacityMask requires aliased geometry; the mask itself is antialiased
+    D2D1_ANTIALIAS_MODE antialiasMode = m_renderTarget->GetAntialiasMode();
+    m_renderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+
+    for (wchar_t ch : text)
+    {
+        const CachedGlyph *glyph = m_glyphCache->find(ch);
+        float x = std::round(pen);
+        pen += glyph->advance;
+        if (glyph->right <= glyph->left)
+        {
+            continue;
+        }
+
+        auto width = static_cast<float>(glyph->right - glyph->left);
+        auto height = static_cast<float>(glyph->bottom - glyph->top);
+        D2D1_RECT_F destination = D2D1::RectF(
+            dip(x + static_cast<float>(glyph->left)),
+            dip(baseline + static_cast<float>(glyph->top)),
+            dip(x + static_cast<float>(glyph->right)),
+            dip(baseline + static_cast<float>(glyph->bottom))
+        );
+        D2D1_RECT_F source = D2D1::RectF(
+            dip(static_cast<float>(glyph->atlasX)),
+            dip(static_cast<float>(glyph->atlasY)),
+            dip(static_cast<float>(glyph->atlasX) + width),
+            dip(static_cast<float>(glyph->atlasY) + height)
+        );
+        m_renderTarget->FillOpacityMask(
+            m_glyphAtlas.Get(),
+            m_blackBrush.Get(),
+            D2D1_OPACITY_MASK_CONTENT_TEXT_NATURAL,
+            &destination,
+            &source
+        );
+    }
+
+    m_renderTarget->SetAntialiasMode(antialiasMode);
+    return true;
+}
 
+void DWriteEngine::drawMetric(const MetricValue& metric, IDWriteTextFormat *format, const D2D1_RECT_F& rect) const
+{
     m_renderTarget->DrawText(
-        info.networkUsage.c_str(),
-        info.networkUsage.size(),
-        m_formatNetwork.Get(),
-        D2D1::RectF(pfLeft, pfHeightBase + pfHeight * 2, pfRight, pfHeightBase + pfHeight * 3),
-        m_blackBrush.Get()
+        metric.text.c_str(),
+        static_cast<UINT32>(metric.text.size()),
+        format,
+        rect,
+        metricBrush(metric)
     );
 }
+
+void DWriteEngine::drawHistory(const MetricHistory& history, double maxValue, const D2D1_RECT_F& rect) const
+{
+    // a narrow window pushes the graph off the left edge; leave it out rather than clip it
+    if (rect.left < 0.0f || maxValue <= 0.0)
+    {
+        return;
+    }
+
+    float width = rect.right - rect.left;
+    auto now = std::chrono::steady_clock::now();
+    auto toPoint = [&](const HistoryPoint& point) {
+        std::chrono::duration<float> age = now - point.time;
+        float x = rect.right - width * age.count() / static_cast<float>(GRAPH_WINDOW.count());
+        float y = rect.bottom - (rect.bottom - rect.top) * static_cast<float>(std::clamp(point.value / maxValue, 0.0, 1.0));
+        return D2D1::Point2F(x, y);
+    };
+
+    m_renderTarget->DrawLine(D2D1::Point2F(rect.left, rect.bottom), D2D1::Point2F(rect.right, rect.bottom), m_grayBrush.Get());
+
+    const HistoryPoint *previous = nullptr;
+    for (size_t i = 0; i < history.size(); i++)
+    {
+        const HistoryPoint& point = history[i];
+        if (point.gap || now - point.time > GRAPH_WINDOW)
+        {
+            previous = nullptr;
+            continue;
+        }
+        if (previous)
+        {
+            m_renderTarget->DrawLine(toPoint(*previous), toPoint(point), m_blackBrush.Get(), 1.5f);
+        }
+        previous = &point;
+    }
+}
+
+void DWriteEngine::drawFleet(const std::vector<FleetHost>& hosts) const
+{
+    std::span<const D2D1_RECT_F> cells = m_layout.fleetCells();
+    if (cells.empty())
+    {
+        return;
+    }
+
+    // keep the last cell for the overflow count
+    size_t shown = hosts.size() > cells.size() ? cells.size() - 1 : hosts.size();
+    auto now = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < shown; i++)
+    {
+        const FleetHost& host = hosts[i];
+        std::wstring cpu = host.metrics.valid(METRIC_CPU)
+            ? std::format(L"{:.1f}%", static_cast<double>(host.metrics.values[METRIC_CPU]) / 10.0)
+            : L"--";
+        std::wstring memory = host.metrics.valid(METRIC_MEMORY)
+            ? std::format(L"{:.1f}G", static_cast<double>(host.metrics.values[METRIC_MEMORY]) / 1024.0)
+            : L"--";
+        std::wstring text = std::format(L"{:<12.12} {:>6} {:>6}", host.name, cpu, memory);
+
+        bool stale = !host.synced || now - host.lastSeen > FLEET_STALE_AFTER;
+        m_renderTarget->DrawText(
+            text.c_str(),
+            static_cast<UINT32>(text.size()),
+            m_formatFleet.Get(),
+            cells[i],
+            stale ? m_grayBrush.Get() : m_blackBrush.Get()
+        );
+    }
+
+    if (shown < hosts.size())
+    {
+        std::wstring text = std::format(L"+{} more", hosts.size() - shown);
+        m_renderTarget->DrawText(
+            text.c_str(),
+            static_cast<UINT32>(text.size()),
+            m_formatFleet.Get(),
+            cells[shown],
+            m_grayBrush.Get()
+        );
+    }
+}
@@ -5,35 +5,110 @@
 #include <d2d1_1.h>
 #include <dwrite.h>
 
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <span>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "DrawInfo.h"
+#include "GlyphCache.h"
+#include "Layout.h"
+
+struct FleetHost;
+class MetricHistory;
+class StartupTrace;
 
 class DWriteEngine
 {
 public:
-    DWriteEngine(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& target, RECT rc);
+    // creates the device-independent resources: factory and text formats, each at its
+    // element's fontSize. safe to call off the UI thread. layout must be static, e.g.
+    // DEFAULT_LAYOUT. glyphCacheReady is called from the loader thread once a glyph
+    // cache can be adopted
+    explicit DWriteEngine(std::span<const LayoutElement> layout, std::function<void()> glyphCacheReady = nullptr);
     ~DWriteEngine() = default;
 
-    void draw(const DrawInfo& info) const;
+    // re-places every element; the glyph atlas is reloaded when the DPI changed.
+    // client size in device pixels
+    void resize(SIZE client, float dpi);
+
+    // maps or builds the timer's glyph atlas for the given DPI on a loader thread, which
+    // also writes a rebuilt cache to disk. until it is adopted the timer falls back to
+    // DrawText. trace, if given, times the load as a startup phase
+    void loadGlyphCache(float dpi, StartupTrace *trace = nullptr);
+
+    // takes over a finished load without waiting; true if the timer atlas changed
+    bool adoptGlyphCache();
+
+    // brushes belong to the render target's device and must be recreated after device loss
+    HRESULT createDeviceResources(const Microsoft::WRL::ComPtr<ID2D1RenderTarget>& target);
+    void releaseDeviceResources();
+
+    // walks the placed layout. elements whose data is null are skipped
+    void draw(const DrawInfo& info, const MetricHistory *cpuHistory, const std::vector<FleetHost> *fleet) const;
 
 private:
+    ID2D1SolidColorBrush *metricBrush(const MetricValue& metric) const;
+
+    HRESULT createGlyphAtlas();
+
+    void drawTimer(const std::wstring& text, const D2D1_RECT_F& rect) const;
+    // false if the atlas is missing, built for another DPI or text has a character outside it
+    bool drawTimerGlyphs(const std::wstring& text, const D2D1_RECT_F& rect) const;
+    void drawMetric(const MetricValue& metric, IDWriteTextFormat *format, const D2D1_RECT_F& rect) const;
+
+    // line graph scaled to 0..maxValue. points are placed by timestamp and the line
+    // breaks at gaps
+    void drawHistory(const MetricHistory& history, double maxValue, const D2D1_RECT_F& rect) const;
+
+    // one of the layout's fleet cells per host, the last one shows how many did not fit
+    void drawFleet(const std::vector<FleetHost>& hosts) const;
+
+    LayoutEngine m_layout;
+    // the DPI the glyph cache was last requested for, even if that failed
+    float m_glyphCacheDpi = 0.0f;
+    // the DPI of the load in flight
+    float m_glyphCacheLoadDpi = 0.0f;
+
+    // device-dependent
     Microsoft::WRL::ComPtr<ID2D1RenderTarget> m_renderTarget;
-    RECT m_rect;
+    Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> m_blackBrush;
+    Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> m_grayBrush;
+    Microsoft::WRL::ComPtr<ID2D1Bitmap> m_glyphAtlas;
 
+    // device-independent
     Microsoft::WRL::ComPtr<IDWriteFactory> m_factory;
-    Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> m_blackBrush;
 
     Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatTimer;
     Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatCPU;
     Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatMemory;
     Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatNetwork;
+    Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatDisk;
+    Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatDiskIo;
+    Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatProcess;
+    Microsoft::WRL::ComPtr<IDWriteTextFormat> m_formatFleet;
+
+    std::unique_ptr<GlyphCache> m_glyphCache;
+    std::function<void()> m_glyphCacheReady;
 
     const std::wstring FONT_FAMILY_TIMER = L"Rounded Mplus 1c";
     const std::wstring FONT_FAMILY_OTHERS = L"Consolas";
     const std::wstring LOCALE = L"ja-JP";
-    const float FONT_SIZE_TIMER = 128.0f;
-    const float FONT_SIZE_OTHERS = 32.0f;
+    // everything the timer ever draws
+    const std::wstring TIMER_ALPHABET = L"0123456789:";
+
+    const std::chrono::seconds GRAPH_WINDOW{60};
+
+    // hosts silent for longer than this are drawn gray
+    const std::chrono::seconds FLEET_STALE_AFTER{5};
+
+    // one load at a time; destroying the engine waits for it
+    std::future<std::unique_ptr<GlyphCache>> m_glyphCacheFuture;
+    std::jthread m_glyphCacheLoader;
 };
 
 
@@ -0,0 +1,396 @@
+#include "DiskMonitor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <pdhmsg.h>
+#else
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+template <typename Char>
+bool sameName(const std::array<wchar_t, 64>& name, const Char *str, size_t len)
+{
+    len = std::min(len, name.size() - 1);
+    for (size_t i = 0; i < len; i++)
+    {
+        if (name[i] != static_cast<wchar_t>(str[i]))
+        {
+            return false;
+        }
+    }
+    return name[len] == L'\0';
+}
+
+template <typename Char>
+void assignName(std::array<wchar_t, 64>& name, const Char *str, size_t len)
+{
+    len = std::min(len, name.size() - 1);
+    for (size_t i = 0; i < len; i++)
+    {
+        name[i] = static_cast<wchar_t>(str[i]);
+    }
+    name[len] = L'\0';
+}
+
+#ifndef _WIN32
+uint64_t parseField(const char *&p, const char *end)
+{
+    while (p < end && *p == ' ')
+    {
+        p++;
+    }
+    uint64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        p++;
+    }
+    return value;
+}
+
+constexpr uint64_t SECTOR_SIZE = 512;
+#endif
+}
+
+#ifdef _WIN32
+
+DiskMonitor::DiskMonitor()
+{
+    PDH_STATUS status = PdhOpenQuery(nullptr, 0, &m_query);
+    if (status != ERROR_SUCCESS || m_query == nullptr)
+    {
+        throw std::runtime_error("failed to open PDH query for disk");
+    }
+
+    const std::array<std::pair<const wchar_t *, HCOUNTER *>, 5> counters = {{
+        {READ_BYTES_COUNTER_PATH, &m_readBytesCounter},
+        {WRITE_BYTES_COUNTER_PATH, &m_writeBytesCounter},
+        {READS_COUNTER_PATH, &m_readsCounter},
+        {WRITES_COUNTER_PATH, &m_writesCounter},
+        {QUEUE_COUNTER_PATH, &m_queueCounter},
+    }};
+    for (const auto& [path, counter] : counters)
+    {
+        status = PdhAddCounter(m_query, path, 0, counter);
+        if (status != ERROR_SUCCESS || *counter == nullptr)
+        {
+            PdhCloseQuery(m_query);
+            m_query = nullptr;
+            throw std::runtime_error("failed to add disk counter");
+        }
+    }
+}
+
+DiskMonitor::~DiskMonitor()
+{
+    if (m_query)
+    {
+        PdhCloseQuery(m_query);
+        m_query = nullptr;
+    }
+}
+
+bool DiskMonitor::collectRaw(HCOUNTER counter, std::vector<std::byte>& buf, DWORD& itemCount) const
+{
+    DWORD bufSize = static_cast<DWORD>(buf.size());
+    PDH_STATUS status = PdhGetRawCounterArray(
+        counter,
+        &bufSize,
+        &itemCount,
+        buf.empty() ? nullptr : reinterpret_cast<PPDH_RAW_COUNTER_ITEM>(buf.data())
+    );
+    if (status == PDH_MORE_DATA)
+    {
+        // instances were added; grow once and keep the larger buffer
+        buf.resize(bufSize);
+        status = PdhGetRawCounterArray(
+            counter,
+            &bufSize,
+            &itemCount,
+            reinterpret_cast<PPDH_RAW_COUNTER_ITEM>(buf.data())
+        );
+    }
+    return status == ERROR_SUCCESS;
+}
+
+void DiskMonitor::sample()
+{
+    PDH_STATUS status = PdhCollectQueryData(m_query);
+    if (status != ERROR_SUCCESS)
+    {
+        std::cerr << "failed to collect disk query data: " << status << std::endl;
+        return;
+    }
+
+    const std::array counters = {
+        m_readBytesCounter,
+        m_writeBytesCounter,
+        m_readsCounter,
+        m_writesCounter,
+        m_queueCounter,
+    };
+    std::array<DWORD, 5> itemCounts = {};
+    for (size_t i = 0; i < counters.size(); i++)
+    {
+        if (!collectRaw(counters[i], m_rawBufs[i], itemCounts[i]))
+        {
+            return;
+        }
+    }
+    if (std::ranges::any_of(itemCounts, [&](DWORD c) { return c != itemCounts[0]; }))
+    {
+        // a disk arrived or left between the array reads; skip this tick
+        return;
+    }
+
+    std::array<PPDH_RAW_COUNTER_ITEM, 5> items = {};
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        items[i] = reinterpret_cast<PPDH_RAW_COUNTER_ITEM>(m_rawBufs[i].data());
+    }
+
+    size_t slot = 0;
+    for (DWORD i = 0; i < itemCounts[0]; i++)
+    {
+        const wchar_t *name = items[0][i].szName;
+        if (wcscmp(name, L"_Total") == 0)
+        {
+            continue;
+        }
+
+        if (slot >= m_devices.size())
+        {
+            resize(slot + 1);
+        }
+
+        DiskDevice& device = m_devices[slot];
+        size_t nameLen = wcslen(name);
+        if (!sameName(device.name, name, nameLen))
+        {
+            assignName(device.name, name, nameLen);
+            m_previous[slot].valid = false;
+        }
+
+        const PDH_RAW_COUNTER& raw = items[0][i].RawValue;
+        RawSample current = {
+            .readBytes = static_cast<uint64_t>(raw.FirstValue),
+            .writeBytes = static_cast<uint64_t>(items[1][i].RawValue.FirstValue),
+            .reads = static_cast<uint64_t>(items[2][i].RawValue.FirstValue),
+            .writes = static_cast<uint64_t>(items[3][i].RawValue.FirstValue),
+            .queueTime = static_cast<uint64_t>(items[4][i].RawValue.FirstValue),
+            .ioTime = 0,
+            .timestamp = (static_cast<uint64_t>(raw.TimeStamp.dwHighDateTime) << 32) | raw.TimeStamp.dwLowDateTime,
+            .valid = true,
+        };
+        update(slot, current);
+        slot++;
+    }
+
+    resize(slot);
+}
+
+#else
+
+DiskMonitor::DiskMonitor()
+{
+    m_fd = open(DISKSTATS_PATH, O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        throw std::runtime_error("failed to open /proc/diskstats");
+    }
+
+    m_readBuf.resize(64 * 1024);
+}
+
+DiskMonitor::~DiskMonitor()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void DiskMonitor::sample()
+{
+    size_t len = 0;
+    for (;;)
+    {
+        if (len == m_readBuf.size())
+        {
+            m_readBuf.resize(m_readBuf.size() * 2);
+        }
+        ssize_t n = pread(m_fd, m_readBuf.data() + len, m_readBuf.size() - len, static_cast<off_t>(len));
+        if (n < 0)
+        {
+            std::cerr << "failed to read /proc/diskstats" << std::endl;
+            return;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        len += static_cast<size_t>(n);
+    }
+
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t nowMs = static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+
+    size_t slot = 0;
+    const char *p = m_readBuf.data();
+    const char *end = p + len;
+    while (p < end)
+    {
+        const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!lineEnd)
+        {
+            lineEnd = end;
+        }
+
+        // major minor name
+        parseField(p, lineEnd);
+        parseField(p, lineEnd);
+        while (p < lineEnd && *p == ' ')
+        {
+            p++;
+        }
+        const char *name = p;
+        while (p < lineEnd && *p != ' ')
+        {
+            p++;
+        }
+        size_t nameLen = static_cast<size_t>(p - name);
+
+        std::array<uint64_t, 11> fields = {};
+        for (auto& field : fields)
+        {
+            field = parseField(p, lineEnd);
+        }
+        p = lineEnd + 1;
+
+        if (nameLen == 0)
+        {
+            continue;
+        }
+
+        if (slot >= m_devices.size())
+        {
+            resize(slot + 1);
+        }
+
+        DiskDevice& device = m_devices[slot];
+        if (!sameName(device.name, name, nameLen))
+        {
+            assignName(device.name, name, nameLen);
+            m_previous[slot].valid = false;
+
+            // only real block devices have a device link; partitions, dm and loop devices do not
+            char path[128];
+            std::snprintf(path, sizeof(path), "/sys/block/%.*s/device", static_cast<int>(nameLen), name);
+            device.physical = access(path, F_OK) == 0;
+        }
+
+        RawSample current = {
+            .readBytes = fields[2] * SECTOR_SIZE,
+            .writeBytes = fields[6] * SECTOR_SIZE,
+            .reads = fields[0],
+            .writes = fields[4],
+            .queueTime = fields[10],
+            .ioTime = fields[3] + fields[7],
+            .timestamp = nowMs,
+            .valid = true,
+        };
+        update(slot, current);
+        slot++;
+    }
+
+    resize(slot);
+}
+
+#endif
+
+void DiskMonitor::resize(size_t count)
+{
+    if (count == m_devices.size())
+    {
+        return;
+    }
+
+    m_devices.resize(count);
+    m_previous.resize(count);
+}
+
+void DiskMonitor::update(size_t index, const RawSample& current)
+{
+    DiskDevice& device = m_devices[index];
+    RawSample& previous = m_previous[index];
+
+    if (previous.valid && current.timestamp > previous.timestamp)
+    {
+        auto delta = [](uint64_t now, uint64_t before) {
+            // counters can reset when a device is re-enumerated
+            return now >= before ? static_cast<double>(now - before) : 0.0;
+        };
+
+        double elapsed = static_cast<double>(current.timestamp - previous.timestamp);
+#ifdef _WIN32
+        double seconds = elapsed / 1e7;
+#else
+        double seconds = elapsed / 1e3;
+#endif
+
+        m_hasRates = true;
+        device.readBytesPerSec = delta(current.readBytes, previous.readBytes) / seconds;
+        device.writeBytesPerSec = delta(current.writeBytes, previous.writeBytes) / seconds;
+        device.readIops = delta(current.reads, previous.reads) / seconds;
+        device.writeIops = delta(current.writes, previous.writes) / seconds;
+
+        // both platforms accumulate queue length over time in the same unit as the timestamp
+        device.queueLength = delta(current.queueTime, previous.queueTime) / elapsed;
+
+#ifdef _WIN32
+        double iops = device.readIops + device.writeIops;
+        // Little's law: average time in the queue = queue length / completion rate
+        device.latencyMs = iops > 0.0 ? device.queueLength / iops * 1000.0 : 0.0;
+#else
+        double ops = delta(current.reads, previous.reads) + delta(current.writes, previous.writes);
+        device.latencyMs = ops > 0.0 ? delta(current.ioTime, previous.ioTime) / ops : 0.0;
+#endif
+    }
+    else
+    {
+        device.readBytesPerSec = 0.0;
+        device.writeBytesPerSec = 0.0;
+        device.readIops = 0.0;
+        device.writeIops = 0.0;
+        device.queueLength = 0.0;
+        device.latencyMs = 0.0;
+    }
+
+    previous = current;
+}
+
+double DiskMonitor::totalBytesPerSec() const
+{
+    double total = 0.0;
+    for (const DiskDevice& device : m_devices)
+    {
+        if (device.physical)
+        {
+            total += device.readBytesPerSec + device.writeBytesPerSec;
+        }
+    }
+    return total;
+}
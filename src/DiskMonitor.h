@@ -0,0 +1,99 @@
+#ifndef SRC_DISKMONITOR_H
+#define SRC_DISKMONITOR_H
+
+#ifdef _WIN32
+#include <windows.h>
+#include <pdh.h>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct DiskDevice
+{
+    std::array<wchar_t, 64> name{};
+    bool physical = true;
+
+    double readBytesPerSec = 0.0;
+    double writeBytesPerSec = 0.0;
+    double readIops = 0.0;
+    double writeIops = 0.0;
+    double queueLength = 0.0;
+    double latencyMs = 0.0;
+};
+
+// per-physical-disk throughput, IOPS and queue depth computed from raw counter deltas.
+// devices live in a flat array that is only reallocated when the device set grows.
+class DiskMonitor
+{
+public:
+    DiskMonitor();
+    ~DiskMonitor();
+
+    DiskMonitor(const DiskMonitor&) = delete;
+    DiskMonitor& operator=(const DiskMonitor&) = delete;
+
+    void sample();
+
+    const std::vector<DiskDevice>& devices() const { return m_devices; }
+
+    // sum of read and write throughput of physical disks
+    double totalBytesPerSec() const;
+
+    // false until two samples were taken, before that every rate reads zero
+    bool hasRates() const { return m_hasRates; }
+
+private:
+    struct RawSample
+    {
+        uint64_t readBytes = 0;
+        uint64_t writeBytes = 0;
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        // windows: queue length * 100ns, linux: weighted ms doing io
+        uint64_t queueTime = 0;
+        // linux only: ms spent reading + writing
+        uint64_t ioTime = 0;
+        // windows: 100ns units, linux: ms
+        uint64_t timestamp = 0;
+        bool valid = false;
+    };
+
+    void resize(size_t count);
+    void update(size_t index, const RawSample& current);
+
+    std::vector<DiskDevice> m_devices;
+    std::vector<RawSample> m_previous;
+    bool m_hasRates = false;
+
+#ifdef _WIN32
+    bool collectRaw(HCOUNTER counter, std::vector<std::byte>& buf, DWORD& itemCount) const;
+
+    HQUERY m_query = nullptr;
+    HCOUNTER m_readBytesCounter = nullptr;
+    HCOUNTER m_writeBytesCounter = nullptr;
+    HCOUNTER m_readsCounter = nullptr;
+    HCOUNTER m_writesCounter = nullptr;
+    HCOUNTER m_queueCounter = nullptr;
+
+    // one buffer per counter, grown on demand and reused across ticks
+    std::array<std::vector<std::byte>, 5> m_rawBufs;
+
+    const wchar_t *READ_BYTES_COUNTER_PATH = L"\\PhysicalDisk(*)\\Disk Read Bytes/sec";
+    const wchar_t *WRITE_BYTES_COUNTER_PATH = L"\\PhysicalDisk(*)\\Disk Write Bytes/sec";
+    const wchar_t *READS_COUNTER_PATH = L"\\PhysicalDisk(*)\\Disk Reads/sec";
+    const wchar_t *WRITES_COUNTER_PATH = L"\\PhysicalDisk(*)\\Disk Writes/sec";
+    const wchar_t *QUEUE_COUNTER_PATH = L"\\PhysicalDisk(*)\\Avg. Disk Queue Length";
+#else
+    int m_fd = -1;
+    std::vector<char> m_readBuf;
+
+    const char *DISKSTATS_PATH = "/proc/diskstats";
+#endif
+};
+
+
+#endif //SRC_DISKMONITOR_H
\ No newline at end of file
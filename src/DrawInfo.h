@@ -2,13 +2,33 @@
 #define SRC_DRAWINFO_H
 
 #include <string>
+#include <vector>
+
+#include "DiskMonitor.h"
+
+struct MetricValue
+{
+    std::wstring text;
+    double value = 0.0;
+
+    // false until the provider produced its first sample
+    bool valid = false;
+    // the last update missed its deadline; text shows the previous value
+    bool stale = false;
+};
 
 struct DrawInfo
 {
     std::wstring timeString;
-    std::wstring cpuUsage;
-    std::wstring memoryUsage;
-    std::wstring networkUsage;
+    MetricValue cpuUsage;
+    MetricValue memoryUsage;
+    MetricValue networkUsage;
+    MetricValue diskUsage;
+    // the busiest physical disk
+    MetricValue diskIo;
+    MetricValue topProcess;
+    // physical disks; empty until the disk provider has rates
+    std::vector<DiskDevice> disks;
 };
 
 
@@ -0,0 +1,54 @@
+#include "Executor.h"
+
+Executor::Executor(std::function<void()> wake)
+    : m_wake(std::move(wake))
+{
+}
+
+void Executor::post(std::coroutine_handle<> handle)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_ready.push_back(handle);
+    }
+    m_cv.notify_one();
+
+    if (m_wake)
+    {
+        m_wake();
+    }
+}
+
+size_t Executor::runReady()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_running.swap(m_ready);
+    }
+
+    size_t count = m_running.size();
+    for (std::coroutine_handle<> handle : m_running)
+    {
+        handle.resume();
+    }
+    m_running.clear();
+    return count;
+}
+
+bool Executor::runUntil(std::chrono::steady_clock::time_point deadline, const std::function<bool()>& done)
+{
+    for (;;)
+    {
+        runReady();
+        if (done())
+        {
+            return true;
+        }
+
+        std::unique_lock lock(m_mutex);
+        if (!m_cv.wait_until(lock, deadline, [this] { return !m_ready.empty(); }))
+        {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef SRC_EXECUTOR_H
+#define SRC_EXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// single-threaded executor: coroutines only ever resume on the thread that drains it.
+// other threads hand continuations back through post(), which also calls the wake
+// callback so the owner's message loop can drain late arrivals.
+class Executor
+{
+public:
+    explicit Executor(std::function<void()> wake = nullptr);
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // thread-safe
+    void post(std::coroutine_handle<> handle);
+
+    // resumes everything posted so far; returns the number of continuations run
+    size_t runReady();
+
+    // resumes posted continuations until done() holds or the deadline passes.
+    // returns done()
+    bool runUntil(std::chrono::steady_clock::time_point deadline, const std::function<bool()>& done);
+
+    template <typename F>
+    class OffloadAwaitable
+    {
+    public:
+        using Result = std::invoke_result_t<F&>;
+
+        OffloadAwaitable(Executor& executor, ThreadPool& pool, F fn)
+            : m_executor(executor), m_pool(pool), m_fn(std::move(fn))
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            // the awaitable lives in the coroutine frame, which stays suspended until post()
+            m_pool.submit([this, handle] {
+                m_result.emplace(m_fn());
+                m_executor.post(handle);
+            });
+        }
+
+        Result await_resume()
+        {
+            return std::move(*m_result);
+        }
+
+    private:
+        Executor& m_executor;
+        ThreadPool& m_pool;
+        F m_fn;
+        std::optional<Result> m_result;
+    };
+
+    template <typename F>
+    class ParallelForAwaitable
+    {
+    public:
+        ParallelForAwaitable(Executor& executor, ThreadPool& pool, size_t count, size_t chunkSize, F fn)
+            : m_executor(executor), m_pool(pool), m_count(count), m_chunkSize(std::max<size_t>(chunkSize, 1)), m_fn(std::move(fn))
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return m_count == 0;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            size_t chunks = chunkCount(m_count, m_chunkSize);
+            m_remaining.store(chunks, std::memory_order_relaxed);
+            for (size_t chunk = 0; chunk < chunks; chunk++)
+            {
+                m_pool.submit([this, handle, chunk] {
+                    size_t begin = chunk * m_chunkSize;
+                    size_t end = std::min(begin + m_chunkSize, m_count);
+                    m_fn(begin, end, chunk);
+
+                    // the last chunk to finish hands the coroutine back
+                    if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        m_executor.post(handle);
+                    }
+                });
+            }
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+
+    private:
+        Executor& m_executor;
+        ThreadPool& m_pool;
+        size_t m_count;
+        size_t m_chunkSize;
+        F m_fn;
+        std::atomic<size_t> m_remaining = 0;
+    };
+
+    static size_t chunkCount(size_t count, size_t chunkSize)
+    {
+        return (count + chunkSize - 1) / chunkSize;
+    }
+
+    // runs fn on the pool and resumes the awaiting coroutine on this executor
+    template <typename F>
+    OffloadAwaitable<F> offload(ThreadPool& pool, F fn)
+    {
+        return OffloadAwaitable<F>(*this, pool, std::move(fn));
+    }
+
+    // splits [0, count) into chunks of chunkSize and runs fn(begin, end, chunkIndex) for
+    // each on the pool. chunks should write to their own slots so merging needs no lock
+    template <typename F>
+    ParallelForAwaitable<F> parallelFor(ThreadPool& pool, size_t count, size_t chunkSize, F fn)
+    {
+        return ParallelForAwaitable<F>(*this, pool, count, chunkSize, std::move(fn));
+    }
+
+private:
+    std::function<void()> m_wake;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::coroutine_handle<>> m_ready;
+    std::vector<std::coroutine_handle<>> m_running;
+};
+
+
+#endif //SRC_EXECUTOR_H
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "Fleet.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "Utf8.h"
+
+namespace
+{
+void setIfValid(MetricTable& table, MetricId id, const MetricValue& metric, double scale)
+{
+    if (metric.valid)
+    {
+        table.set(id, std::llround(metric.value * scale));
+    }
+}
+}
+
+WinsockSession::WinsockSession()
+{
+    WSADATA data;
+    int result = WSAStartup(MAKEWORD(2, 2), &data);
+    if (result != 0)
+    {
+        throw std::runtime_error("failed to initialize winsock");
+    }
+}
+
+WinsockSession::~WinsockSession()
+{
+    WSACleanup();
+}
+
+MetricTable toMetricTable(const DrawInfo& info)
+{
+    MetricTable table;
+    setIfValid(table, METRIC_CPU, info.cpuUsage, 10.0);
+    setIfValid(table, METRIC_MEMORY, info.memoryUsage, 1.0 / (1024 * 1024));
+    setIfValid(table, METRIC_NETWORK, info.networkUsage, 1.0 / 1024);
+    setIfValid(table, METRIC_DISK, info.diskUsage, 1.0 / 1024);
+    setIfValid(table, METRIC_PROCESS, info.topProcess, 10.0);
+    return table;
+}
+
+FleetPublisher::FleetPublisher(const std::wstring& target, const std::wstring& hostName)
+    : m_encoder(hostIdFromName(toUtf8(hostName)), toUtf8(hostName))
+{
+    size_t colon = target.rfind(L':');
+    if (colon == std::wstring::npos)
+    {
+        throw std::invalid_argument("publish target must be host:port");
+    }
+    std::wstring host = target.substr(0, colon);
+    std::wstring port = target.substr(colon + 1);
+
+    ADDRINFOW hints = {
+        // the aggregator only listens on IPv4
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_DGRAM,
+        .ai_protocol = IPPROTO_UDP,
+    };
+    ADDRINFOW *result = nullptr;
+    if (GetAddrInfoW(host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr)
+    {
+        throw std::runtime_error("failed to resolve publish target");
+    }
+
+    m_socket = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    std::memcpy(&m_target, result->ai_addr, result->ai_addrlen);
+    m_targetLen = static_cast<int>(result->ai_addrlen);
+    FreeAddrInfoW(result);
+
+    if (m_socket == INVALID_SOCKET)
+    {
+        throw std::runtime_error("failed to create publish socket");
+    }
+}
+
+FleetPublisher::~FleetPublisher()
+{
+    if (m_socket != INVALID_SOCKET)
+    {
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+}
+
+void FleetPublisher::publish(const DrawInfo& info)
+{
+    size_t size = m_encoder.encode(toMetricTable(info), m_frame);
+    if (size == 0)
+    {
+        return;
+    }
+
+    int sent = sendto(
+        m_socket,
+        reinterpret_cast<const char *>(m_frame.data()),
+        static_cast<int>(size),
+        0,
+        reinterpret_cast<const sockaddr *>(&m_target),
+        m_targetLen
+    );
+    if (sent == SOCKET_ERROR)
+    {
+        std::cerr << "failed to publish snapshot: " << WSAGetLastError() << std::endl;
+    }
+}
+
+FleetAggregator::FleetAggregator(uint16_t port)
+{
+    m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_socket == INVALID_SOCKET)
+    {
+        throw std::runtime_error("failed to create aggregate socket");
+    }
+
+    // a thousand hosts at 1 Hz is ~25 KB/s; leave room for bursts between drains
+    int bufferSize = 4 * 1024 * 1024;
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char *>(&bufferSize), sizeof(bufferSize));
+
+    sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+    };
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(m_socket, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == SOCKET_ERROR)
+    {
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+        throw std::runtime_error("failed to bind aggregate socket");
+    }
+
+}
+
+FleetAggregator::~FleetAggregator()
+{
+    if (m_socket != INVALID_SOCKET)
+    {
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+}
+
+void FleetAggregator::attach(HWND hwnd, UINT message)
+{
+    if (WSAAsyncSelect(m_socket, hwnd, message, FD_READ) == SOCKET_ERROR)
+    {
+        std::cerr << "failed to select aggregate socket: " << WSAGetLastError() << std::endl;
+    }
+}
+
+size_t FleetAggregator::receive()
+{
+    size_t applied = 0;
+    for (;;)
+    {
+        sockaddr_in from = {};
+        int fromLen = sizeof(from);
+        int size = recvfrom(
+            m_socket,
+            reinterpret_cast<char *>(m_datagram.data()),
+            static_cast<int>(m_datagram.size()),
+            0,
+            reinterpret_cast<sockaddr *>(&from),
+            &fromLen
+        );
+        if (size == SOCKET_ERROR)
+        {
+            int error = WSAGetLastError();
+            if (error != WSAEWOULDBLOCK && error != WSAEMSGSIZE && error != WSAECONNRESET)
+            {
+                std::cerr << "failed to receive snapshot: " << error << std::endl;
+            }
+            if (error == WSAEMSGSIZE || error == WSAECONNRESET)
+            {
+                // oversized or ICMP-triggered; skip it and keep draining
+                continue;
+            }
+            break;
+        }
+
+        if (m_table.apply(from.sin_addr.s_addr, std::span<const uint8_t>(m_datagram.data(), static_cast<size_t>(size))))
+        {
+            applied++;
+        }
+    }
+    return applied;
+}
@@ -0,0 +1,84 @@
+#ifndef SRC_FLEET_H
+#define SRC_FLEET_H
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DrawInfo.h"
+#include "FleetTable.h"
+#include "SnapshotCodec.h"
+
+// WSAStartup is reference counted; every socket owner holds one of these
+class WinsockSession
+{
+public:
+    WinsockSession();
+    ~WinsockSession();
+
+    WinsockSession(const WinsockSession&) = delete;
+    WinsockSession& operator=(const WinsockSession&) = delete;
+};
+
+MetricTable toMetricTable(const DrawInfo& info);
+
+// sends one compact frame per tick to an aggregator over UDP
+class FleetPublisher
+{
+public:
+    // target is "host:port"
+    FleetPublisher(const std::wstring& target, const std::wstring& hostName);
+    ~FleetPublisher();
+
+    FleetPublisher(const FleetPublisher&) = delete;
+    FleetPublisher& operator=(const FleetPublisher&) = delete;
+
+    void publish(const DrawInfo& info);
+
+private:
+    WinsockSession m_winsock;
+    SOCKET m_socket = INVALID_SOCKET;
+    sockaddr_storage m_target = {};
+    int m_targetLen = 0;
+
+    SnapshotEncoder m_encoder;
+    std::array<uint8_t, SnapshotEncoder::MAX_FRAME_SIZE> m_frame = {};
+};
+
+// receives frames from many publishers into a FleetTable
+class FleetAggregator
+{
+public:
+    explicit FleetAggregator(uint16_t port);
+    ~FleetAggregator();
+
+    FleetAggregator(const FleetAggregator&) = delete;
+    FleetAggregator& operator=(const FleetAggregator&) = delete;
+
+    // makes the socket non-blocking and posts message to hwnd whenever datagrams arrive
+    void attach(HWND hwnd, UINT message);
+
+    // drains every pending datagram; returns the number of frames applied
+    size_t receive();
+
+    const std::vector<FleetHost>& hosts() const
+    {
+        return m_table.hosts();
+    }
+
+private:
+    WinsockSession m_winsock;
+    SOCKET m_socket = INVALID_SOCKET;
+
+    FleetTable m_table;
+
+    std::array<uint8_t, 1500> m_datagram = {};
+};
+
+
+#endif //SRC_FLEET_H
\ No newline at end of file
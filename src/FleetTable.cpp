@@ -0,0 +1,89 @@
+#include "FleetTable.h"
+
+#include "Utf8.h"
+
+namespace
+{
+uint64_t hostKey(uint32_t address, uint32_t hostId)
+{
+    return static_cast<uint64_t>(address) << 32 | hostId;
+}
+}
+
+FleetTable::FleetTable()
+{
+    m_hosts.reserve(1024);
+    m_hostIndex.reserve(1024);
+}
+
+bool FleetTable::apply(uint32_t address, std::span<const uint8_t> frame)
+{
+    FrameReader reader(frame);
+    FrameHeader header;
+    if (!reader.readHeader(header))
+    {
+        return false;
+    }
+
+    auto it = m_hostIndex.find(hostKey(address, header.hostId));
+    FleetHost *host = it != m_hostIndex.end() ? &m_hosts[it->second] : nullptr;
+
+    if (!header.keyframe)
+    {
+        if (!host || !host->synced)
+        {
+            return false;
+        }
+
+        // unsigned, so a sender that restarted lands far outside the keyframe's frames
+        uint32_t sinceKeyframe = header.sequence - host->keyframeSequence;
+        if (sinceKeyframe >= SnapshotEncoder::KEYFRAME_INTERVAL)
+        {
+            // the keyframe this delta belongs to was lost; wait for the next one
+            host->synced = false;
+            return false;
+        }
+        if (sinceKeyframe <= host->sequence - host->keyframeSequence)
+        {
+            // reordered or duplicated; the table already shows something newer
+            return false;
+        }
+    }
+
+    MetricTable metrics;
+    if (!reader.readValues(host ? host->keyframe : MetricTable{}, metrics))
+    {
+        return false;
+    }
+    if (header.keyframe && !reader.readHostName(m_nameBuf))
+    {
+        return false;
+    }
+
+    if (!host)
+    {
+        // new hosts only arrive through keyframes, so they always have a name
+        if (m_hosts.size() >= MAX_HOSTS)
+        {
+            return false;
+        }
+        m_hostIndex.emplace(hostKey(address, header.hostId), static_cast<uint32_t>(m_hosts.size()));
+        host = &m_hosts.emplace_back(FleetHost{
+            .address = address,
+            .hostId = header.hostId,
+        });
+    }
+
+    if (header.keyframe)
+    {
+        assignFromUtf8(host->name, m_nameBuf);
+        host->keyframe = metrics;
+        host->keyframeSequence = header.sequence;
+    }
+
+    host->metrics = metrics;
+    host->sequence = header.sequence;
+    host->synced = true;
+    host->lastSeen = std::chrono::steady_clock::now();
+    return true;
+}
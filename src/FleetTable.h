@@ -0,0 +1,57 @@
+#ifndef SRC_FLEETTABLE_H
+#define SRC_FLEETTABLE_H
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SnapshotCodec.h"
+
+struct FleetHost
+{
+    // IPv4 address the frames come from, network byte order
+    uint32_t address = 0;
+    uint32_t hostId = 0;
+    uint32_t sequence = 0;
+    uint32_t keyframeSequence = 0;
+    // false after a lost keyframe until the next one
+    bool synced = false;
+    std::chrono::steady_clock::time_point lastSeen;
+
+    std::wstring name;
+    // the base of every delta until the next keyframe
+    MetricTable keyframe;
+    MetricTable metrics;
+};
+
+// frames from many publishers in a flat per-host table. host ids are hashes of the
+// name, so hosts are keyed by sender address and host id: two machines whose names
+// collide still get a slot each
+class FleetTable
+{
+public:
+    FleetTable();
+
+    // address is the sender's IPv4 address in network byte order. returns false for
+    // malformed frames and deltas that cannot be applied
+    bool apply(uint32_t address, std::span<const uint8_t> frame);
+
+    const std::vector<FleetHost>& hosts() const
+    {
+        return m_hosts;
+    }
+
+private:
+    std::vector<FleetHost> m_hosts;
+    std::unordered_map<uint64_t, uint32_t> m_hostIndex;
+
+    std::string m_nameBuf;
+
+    const size_t MAX_HOSTS = 65536;
+};
+
+
+#endif //SRC_FLEETTABLE_H
\ No newline at end of file
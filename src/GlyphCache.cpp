@@ -0,0 +1,523 @@
+#include "GlyphCache.h"
+
+#include <shlobj.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+struct GlyphCache::Header
+{
+    uint32_t magic;
+    uint32_t version;
+    // path, size and write time of every font file, face index and simulations
+    uint64_t fontKey;
+    uint64_t alphabetHash;
+    float fontSize;
+    float dpi;
+    uint32_t renderSettings;
+    uint32_t glyphCount;
+    uint32_t atlasWidth;
+    uint32_t atlasHeight;
+    float ascent;
+    // FNV-1a of everything after the header
+    uint32_t checksum;
+};
+
+static_assert(sizeof(CachedGlyph) == 32);
+
+namespace
+{
+constexpr uint32_t CACHE_MAGIC = 0x43474B43; // "CKGC"
+constexpr uint32_t CACHE_VERSION = 1;
+
+constexpr DWRITE_RENDERING_MODE RENDERING_MODE = DWRITE_RENDERING_MODE_NATURAL_SYMMETRIC;
+constexpr DWRITE_MEASURING_MODE MEASURING_MODE = DWRITE_MEASURING_MODE_NATURAL;
+constexpr DWRITE_GRID_FIT_MODE GRID_FIT_MODE = DWRITE_GRID_FIT_MODE_DEFAULT;
+constexpr DWRITE_TEXT_ANTIALIAS_MODE ANTIALIAS_MODE = DWRITE_TEXT_ANTIALIAS_MODE_GRAYSCALE;
+
+constexpr uint32_t RENDER_SETTINGS =
+    static_cast<uint32_t>(RENDERING_MODE)
+    | static_cast<uint32_t>(MEASURING_MODE) << 8
+    | static_cast<uint32_t>(GRID_FIT_MODE) << 16
+    | static_cast<uint32_t>(ANTIALIAS_MODE) << 24;
+
+// FNV-1a
+void hash64(uint64_t& hash, const void *data, size_t size)
+{
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+uint32_t checksum32(const uint8_t *data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Microsoft::WRL::ComPtr<IDWriteFontFace> resolveFontFace(
+    const Microsoft::WRL::ComPtr<IDWriteFactory>& factory,
+    const std::wstring& fontFamily,
+    DWRITE_FONT_WEIGHT fontWeight
+)
+{
+    Microsoft::WRL::ComPtr<IDWriteFontCollection> collection;
+    if (FAILED(factory->GetSystemFontCollection(&collection)))
+    {
+        throw std::runtime_error("failed to get system font collection");
+    }
+
+    UINT32 index = 0;
+    BOOL exists = FALSE;
+    if (FAILED(collection->FindFamilyName(fontFamily.c_str(), &index, &exists)) || !exists)
+    {
+        throw std::runtime_error("font family is not installed");
+    }
+
+    Microsoft::WRL::ComPtr<IDWriteFontFamily> family;
+    Microsoft::WRL::ComPtr<IDWriteFont> font;
+    Microsoft::WRL::ComPtr<IDWriteFontFace> face;
+    if (FAILED(collection->GetFontFamily(index, &family))
+        || FAILED(family->GetFirstMatchingFont(fontWeight, DWRITE_FONT_STRETCH_NORMAL, DWRITE_FONT_STYLE_NORMAL, &font))
+        || FAILED(font->CreateFontFace(&face)))
+    {
+        throw std::runtime_error("failed to create font face");
+    }
+    return face;
+}
+
+// hashing the font files themselves would read megabytes on every start; their path,
+// size and write time change whenever the font is updated, which is what matters here
+uint64_t fontFileKey(IDWriteFontFace *face)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    UINT32 fileCount = 0;
+    if (FAILED(face->GetFiles(&fileCount, nullptr)))
+    {
+        throw std::runtime_error("failed to get font files");
+    }
+    std::vector<IDWriteFontFile *> rawFiles(fileCount);
+    if (FAILED(face->GetFiles(&fileCount, rawFiles.data())))
+    {
+        throw std::runtime_error("failed to get font files");
+    }
+    std::vector<Microsoft::WRL::ComPtr<IDWriteFontFile>> files(fileCount);
+    for (UINT32 i = 0; i < fileCount; i++)
+    {
+        files[i].Attach(rawFiles[i]);
+    }
+
+    for (const auto& file : files)
+    {
+        const void *referenceKey = nullptr;
+        UINT32 referenceKeySize = 0;
+        Microsoft::WRL::ComPtr<IDWriteFontFileLoader> loader;
+        Microsoft::WRL::ComPtr<IDWriteLocalFontFileLoader> localLoader;
+        if (FAILED(file->GetReferenceKey(&referenceKey, &referenceKeySize))
+            || FAILED(file->GetLoader(&loader))
+            || FAILED(loader.As(&localLoader)))
+        {
+            throw std::runtime_error("font is not a local file");
+        }
+
+        UINT32 length = 0;
+        if (FAILED(localLoader->GetFilePathLengthFromKey(referenceKey, referenceKeySize, &length)))
+        {
+            throw std::runtime_error("failed to get font file path");
+        }
+        std::wstring path(length + 1, L'\0');
+        FILETIME writeTime = {};
+        if (FAILED(localLoader->GetFilePathFromKey(referenceKey, referenceKeySize, path.data(), length + 1))
+            || FAILED(localLoader->GetLastWriteTimeFromKey(referenceKey, referenceKeySize, &writeTime)))
+        {
+            throw std::runtime_error("failed to get font file path");
+        }
+        path.resize(length);
+
+        WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+        if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &attributes))
+        {
+            throw std::runtime_error("failed to stat font file");
+        }
+
+        hash64(hash, path.data(), path.size() * sizeof(wchar_t));
+        hash64(hash, &writeTime, sizeof(writeTime));
+        hash64(hash, &attributes.nFileSizeHigh, sizeof(attributes.nFileSizeHigh));
+        hash64(hash, &attributes.nFileSizeLow, sizeof(attributes.nFileSizeLow));
+    }
+
+    UINT32 faceIndex = face->GetIndex();
+    DWRITE_FONT_SIMULATIONS simulations = face->GetSimulations();
+    hash64(hash, &faceIndex, sizeof(faceIndex));
+    hash64(hash, &simulations, sizeof(simulations));
+    return hash;
+}
+}
+
+// one file per size and DPI, so moving between monitors does not thrash a single file
+std::filesystem::path GlyphCache::cachePath(float fontSize, float dpi)
+{
+    PWSTR folder = nullptr;
+    HRESULT hr = SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &folder);
+    if (FAILED(hr))
+    {
+        CoTaskMemFree(folder);
+        return {};
+    }
+    std::filesystem::path directory = std::filesystem::path(folder) / L"clockapp";
+    CoTaskMemFree(folder);
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec)
+    {
+        return {};
+    }
+    return directory / std::format(L"glyphs-{}-{}.bin", static_cast<int>(fontSize), static_cast<int>(dpi));
+}
+
+GlyphCache::GlyphCache(
+    const Microsoft::WRL::ComPtr<IDWriteFactory>& factory,
+    const std::wstring& fontFamily,
+    DWRITE_FONT_WEIGHT fontWeight,
+    float fontSize,
+    float dpi,
+    std::wstring_view alphabet
+)
+{
+    Microsoft::WRL::ComPtr<IDWriteFontFace> face = resolveFontFace(factory, fontFamily, fontWeight);
+
+    uint64_t alphabetHash = 14695981039346656037ull;
+    hash64(alphabetHash, alphabet.data(), alphabet.size() * sizeof(wchar_t));
+
+    Header key = {
+        .magic = CACHE_MAGIC,
+        .version = CACHE_VERSION,
+        .fontKey = fontFileKey(face.Get()),
+        .alphabetHash = alphabetHash,
+        .fontSize = fontSize,
+        .dpi = dpi,
+        .renderSettings = RENDER_SETTINGS,
+        .glyphCount = static_cast<uint32_t>(alphabet.size()),
+    };
+
+    std::filesystem::path path = cachePath(fontSize, dpi);
+    if (!path.empty() && map(path, key))
+    {
+        m_warm = true;
+        return;
+    }
+
+    Microsoft::WRL::ComPtr<IDWriteFactory2> factory2;
+    if (FAILED(factory.As(&factory2)))
+    {
+        throw std::runtime_error("glyph rasterization needs IDWriteFactory2");
+    }
+    rasterize(key, factory2.Get(), face.Get(), alphabet);
+
+    if (!path.empty())
+    {
+        persist(path);
+        if (map(path, key))
+        {
+            m_built.clear();
+            return;
+        }
+    }
+
+    // no writable cache directory, or another instance holds the file open
+    m_data = m_built.data();
+}
+
+GlyphCache::~GlyphCache()
+{
+    unmap();
+}
+
+const CachedGlyph *GlyphCache::find(wchar_t ch) const
+{
+    const CachedGlyph *begin = glyphs();
+    const CachedGlyph *end = begin + header().glyphCount;
+    const CachedGlyph *glyph = std::find_if(begin, end, [ch](const CachedGlyph& g) {
+        return g.codepoint == static_cast<uint32_t>(ch);
+    });
+    return glyph != end ? glyph : nullptr;
+}
+
+const uint8_t *GlyphCache::atlas() const
+{
+    return reinterpret_cast<const uint8_t *>(glyphs() + header().glyphCount);
+}
+
+uint32_t GlyphCache::atlasWidth() const
+{
+    return header().atlasWidth;
+}
+
+uint32_t GlyphCache::atlasHeight() const
+{
+    return header().atlasHeight;
+}
+
+float GlyphCache::ascent() const
+{
+    return header().ascent;
+}
+
+float GlyphCache::dpi() const
+{
+    return header().dpi;
+}
+
+const GlyphCache::Header& GlyphCache::header() const
+{
+    return *reinterpret_cast<const Header *>(m_data);
+}
+
+const CachedGlyph *GlyphCache::glyphs() const
+{
+    return reinterpret_cast<const CachedGlyph *>(m_data + sizeof(Header));
+}
+
+bool GlyphCache::map(const std::filesystem::path& path, const Header& expected)
+{
+    m_file = CreateFile(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(Header)))
+    {
+        unmap();
+        return false;
+    }
+
+    m_mapping = CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping)
+    {
+        m_view = static_cast<const uint8_t *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!m_view)
+    {
+        unmap();
+        return false;
+    }
+
+    const Header& header = *reinterpret_cast<const Header *>(m_view);
+    uint64_t expectedSize = sizeof(Header)
+        + static_cast<uint64_t>(header.glyphCount) * sizeof(CachedGlyph)
+        + static_cast<uint64_t>(header.atlasWidth) * header.atlasHeight;
+
+    bool valid = header.magic == expected.magic
+        && header.version == expected.version
+        && header.fontKey == expected.fontKey
+        && header.alphabetHash == expected.alphabetHash
+        && header.fontSize == expected.fontSize
+        && header.dpi == expected.dpi
+        && header.renderSettings == expected.renderSettings
+        && header.glyphCount == expected.glyphCount
+        && expectedSize == static_cast<uint64_t>(size.QuadPart)
+        && header.checksum == checksum32(m_view + sizeof(Header), static_cast<size_t>(expectedSize) - sizeof(Header));
+    if (!valid)
+    {
+        unmap();
+        return false;
+    }
+
+    m_data = m_view;
+    return true;
+}
+
+void GlyphCache::unmap()
+{
+    if (m_view)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+}
+
+void GlyphCache::rasterize(const Header& key, IDWriteFactory2 *factory, IDWriteFontFace *face, std::wstring_view alphabet)
+{
+    DWRITE_FONT_METRICS fontMetrics = {};
+    face->GetMetrics(&fontMetrics);
+    float emSize = key.fontSize * key.dpi / 96.0f;
+    float designScale = emSize / static_cast<float>(fontMetrics.designUnitsPerEm);
+
+    size_t count = alphabet.size();
+    std::vector<UINT32> codepoints(alphabet.begin(), alphabet.end());
+    std::vector<UINT16> indices(count);
+    std::vector<DWRITE_GLYPH_METRICS> metrics(count);
+    if (FAILED(face->GetGlyphIndices(codepoints.data(), static_cast<UINT32>(count), indices.data()))
+        || std::ranges::find(indices, 0) != indices.end()
+        || FAILED(face->GetDesignGlyphMetrics(indices.data(), static_cast<UINT32>(count), metrics.data(), FALSE)))
+    {
+        throw std::runtime_error("font lacks a glyph of the cached alphabet");
+    }
+
+    std::vector<CachedGlyph> glyphs(count);
+    std::vector<std::vector<BYTE>> textures(count);
+    uint32_t atlasWidth = 0;
+    int32_t atlasTop = INT_MAX;
+    int32_t atlasBottom = INT_MIN;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        FLOAT advance = 0.0f;
+        DWRITE_GLYPH_OFFSET offset = {};
+        DWRITE_GLYPH_RUN run = {
+            .fontFace = face,
+            .fontEmSize = emSize,
+            .glyphCount = 1,
+            .glyphIndices = &indices[i],
+            .glyphAdvances = &advance,
+            .glyphOffsets = &offset,
+            .isSideways = FALSE,
+            .bidiLevel = 0,
+        };
+
+        Microsoft::WRL::ComPtr<IDWriteGlyphRunAnalysis> analysis;
+        RECT bounds = {};
+        HRESULT hr = factory->CreateGlyphRunAnalysis(
+            &run,
+            nullptr,
+            RENDERING_MODE,
+            MEASURING_MODE,
+            GRID_FIT_MODE,
+            ANTIALIAS_MODE,
+            0.0f,
+            0.0f,
+            &analysis
+        );
+        if (SUCCEEDED(hr))
+        {
+            hr = analysis->GetAlphaTextureBounds(DWRITE_TEXTURE_ALIASED_1x1, &bounds);
+        }
+
+        auto width = static_cast<uint32_t>(bounds.right - bounds.left);
+        auto height = static_cast<uint32_t>(bounds.bottom - bounds.top);
+        textures[i].resize(static_cast<size_t>(width) * height);
+        if (SUCCEEDED(hr) && !textures[i].empty())
+        {
+            hr = analysis->CreateAlphaTexture(DWRITE_TEXTURE_ALIASED_1x1, &bounds, textures[i].data(), static_cast<UINT32>(textures[i].size()));
+        }
+        if (FAILED(hr))
+        {
+            std::cerr << "failed to rasterize glyph" << std::endl;
+            throw std::runtime_error("failed to rasterize glyph");
+        }
+
+        glyphs[i] = CachedGlyph{
+            .codepoint = codepoints[i],
+            .advance = static_cast<float>(metrics[i].advanceWidth) * designScale,
+            .left = bounds.left,
+            .top = bounds.top,
+            .right = bounds.right,
+            .bottom = bounds.bottom,
+            .atlasX = atlasWidth,
+            .atlasY = 0,
+        };
+
+        // one empty column between glyphs so neighbours never bleed into each other
+        atlasWidth += width + 1;
+        if (!textures[i].empty())
+        {
+            atlasTop = std::min(atlasTop, static_cast<int32_t>(bounds.top));
+            atlasBottom = std::max(atlasBottom, static_cast<int32_t>(bounds.bottom));
+        }
+    }
+    if (atlasTop > atlasBottom)
+    {
+        atlasTop = atlasBottom = 0;
+    }
+    auto atlasHeight = static_cast<uint32_t>(atlasBottom - atlasTop);
+
+    Header header = key;
+    header.atlasWidth = atlasWidth;
+    header.atlasHeight = atlasHeight;
+    header.ascent = static_cast<float>(fontMetrics.ascent) * designScale;
+
+    size_t glyphBytes = count * sizeof(CachedGlyph);
+    m_built.assign(sizeof(Header) + glyphBytes + static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+    uint8_t *atlas = m_built.data() + sizeof(Header) + glyphBytes;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CachedGlyph& glyph = glyphs[i];
+        glyph.atlasY = static_cast<uint32_t>(glyph.top - atlasTop);
+
+        auto width = static_cast<size_t>(glyph.right - glyph.left);
+        auto height = static_cast<size_t>(glyph.bottom - glyph.top);
+        for (size_t row = 0; row < height && width > 0; row++)
+        {
+            std::memcpy(
+                atlas + (glyph.atlasY + row) * atlasWidth + glyph.atlasX,
+                textures[i].data() + row * width,
+                width
+            );
+        }
+    }
+    std::memcpy(m_built.data() + sizeof(Header), glyphs.data(), glyphBytes);
+
+    header.checksum = checksum32(m_built.data() + sizeof(Header), m_built.size() - sizeof(Header));
+    std::memcpy(m_built.data(), &header, sizeof(Header));
+}
+
+void GlyphCache::persist(const std::filesystem::path& path) const
+{
+    // readers only ever see the old file or the complete new one
+    std::filesystem::path temp = path;
+    temp += std::format(L".{}.tmp", GetCurrentProcessId());
+
+    HANDLE file = CreateFile(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "failed to create glyph cache file" << std::endl;
+        return;
+    }
+
+    DWORD written = 0;
+    bool ok = WriteFile(file, m_built.data(), static_cast<DWORD>(m_built.size()), &written, nullptr)
+        && written == m_built.size()
+        && FlushFileBuffers(file);
+    CloseHandle(file);
+
+    if (!ok || !MoveFileEx(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        std::cerr << "failed to replace glyph cache file" << std::endl;
+        DeleteFile(temp.c_str());
+    }
+}
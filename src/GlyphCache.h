@@ -0,0 +1,93 @@
+#ifndef SRC_GLYPHCACHE_H
+#define SRC_GLYPHCACHE_H
+
+#include <windows.h>
+#include <dwrite_2.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// one rasterized glyph. bounds are whole pixels relative to the pen position on the
+// baseline; the alpha texture sits at (atlasX, atlasY) in the atlas
+struct CachedGlyph
+{
+    uint32_t codepoint;
+    float advance;
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    uint32_t atlasX;
+    uint32_t atlasY;
+};
+
+// a small alphabet rasterized once to an A8 atlas and persisted under
+// %LOCALAPPDATA%\clockapp. warm starts map the file and skip font rasterization
+// entirely; a file whose key (font file, size, DPI, render settings, alphabet) does
+// not match is rebuilt and atomically replaced.
+class GlyphCache
+{
+public:
+    // throws std::runtime_error if the font cannot be resolved to a local file or
+    // lacks a glyph of the alphabet
+    GlyphCache(
+        const Microsoft::WRL::ComPtr<IDWriteFactory>& factory,
+        const std::wstring& fontFamily,
+        DWRITE_FONT_WEIGHT fontWeight,
+        float fontSize,
+        float dpi,
+        std::wstring_view alphabet
+    );
+    ~GlyphCache();
+
+    GlyphCache(const GlyphCache&) = delete;
+    GlyphCache& operator=(const GlyphCache&) = delete;
+
+    // nullptr if ch is not part of the alphabet
+    const CachedGlyph *find(wchar_t ch) const;
+
+    const uint8_t *atlas() const;
+    uint32_t atlasWidth() const;
+    uint32_t atlasHeight() const;
+
+    // in pixels at dpi()
+    float ascent() const;
+    float dpi() const;
+
+    // where the cache for a size and DPI lives; empty if %LOCALAPPDATA% is unavailable
+    static std::filesystem::path cachePath(float fontSize, float dpi);
+
+    // true if the glyphs came from the file rather than the rasterizer
+    bool warm() const
+    {
+        return m_warm;
+    }
+
+private:
+    struct Header;
+
+    const Header& header() const;
+    const CachedGlyph *glyphs() const;
+
+    bool map(const std::filesystem::path& path, const Header& expected);
+    void unmap();
+    void rasterize(const Header& key, IDWriteFactory2 *factory, IDWriteFontFace *face, std::wstring_view alphabet);
+    void persist(const std::filesystem::path& path) const;
+
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t *m_view = nullptr;
+
+    // the rasterized file image when it could not be mapped back
+    std::vector<uint8_t> m_built;
+
+    const uint8_t *m_data = nullptr;
+    bool m_warm = false;
+};
+
+
+#endif //SRC_GLYPHCACHE_H
\ No newline at end of file
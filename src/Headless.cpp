@@ -0,0 +1,196 @@
+#include "Headless.h"
+
+#include <array>
+#include <chrono>
+#include <format>
+#include <thread>
+#include <vector>
+
+#include "Utf8.h"
+
+namespace
+{
+// a GUI-subsystem process has no console of its own. redirected handles are inherited
+// as-is; otherwise borrow the console of whoever started us.
+HANDLE acquireStdout()
+{
+    HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (handle != nullptr && handle != INVALID_HANDLE_VALUE)
+    {
+        return handle;
+    }
+
+    if (!AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        return nullptr;
+    }
+    SetConsoleOutputCP(CP_UTF8);
+    return CreateFile(L"CONOUT$", GENERIC_WRITE, FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+}
+
+std::string jsonString(const std::wstring& str)
+{
+    std::string result = "\"";
+    for (char c : toUtf8(str))
+    {
+        switch (c)
+        {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                result += std::format("\\u{:04x}", static_cast<unsigned>(c));
+            }
+            else
+            {
+                result += c;
+            }
+        }
+    }
+    result += '"';
+    return result;
+}
+
+std::string jsonMetric(const char *name, const MetricValue& metric)
+{
+    return std::format(
+        "\"{}\":{{\"value\":{},\"valid\":{},\"stale\":{},\"text\":{}}}",
+        name,
+        metric.value,
+        metric.valid,
+        metric.stale,
+        jsonString(metric.text)
+    );
+}
+
+std::string jsonDisks(const std::vector<DiskDevice>& disks)
+{
+    std::string result = "[";
+    for (const DiskDevice& disk : disks)
+    {
+        if (result.size() > 1)
+        {
+            result += ',';
+        }
+        result += std::format(
+            "{{\"name\":{},\"readBytesPerSec\":{},\"writeBytesPerSec\":{},\"readIops\":{},\"writeIops\":{},\"queueLength\":{},\"latencyMs\":{}}}",
+            jsonString(disk.name.data()),
+            disk.readBytesPerSec,
+            disk.writeBytesPerSec,
+            disk.readIops,
+            disk.writeIops,
+            disk.queueLength,
+            disk.latencyMs
+        );
+    }
+    result += ']';
+    return result;
+}
+}
+
+// records are promised at a fixed rate, so every metric is sampled at exactly that rate
+Headless::Headless(const Options& options)
+    : m_options(options),
+      m_stdout(acquireStdout()),
+      m_resourceMonitor(nullptr, SamplerConfig{.minInterval = options.interval, .maxInterval = options.interval})
+{
+}
+
+int Headless::run()
+{
+    if (m_stdout == nullptr || m_stdout == INVALID_HANDLE_VALUE)
+    {
+        return -1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto next = Clock::now();
+
+    // rate counters need a pair of samples one interval apart before the first record
+    sample();
+    next += m_options.interval;
+    std::this_thread::sleep_until(next);
+    sample();
+    if (!print(m_resourceMonitor.snapshot()))
+    {
+        return -1;
+    }
+
+    while (m_options.watch)
+    {
+        next += m_options.interval;
+        std::this_thread::sleep_until(next);
+        sample();
+        if (!print(m_resourceMonitor.snapshot()))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void Headless::sample()
+{
+    // no message loop here: pick up providers that finished after the previous deadline first
+    m_resourceMonitor.runReady();
+    m_resourceMonitor.tick();
+}
+
+bool Headless::print(const DrawInfo& info)
+{
+    return write(m_options.json ? formatJson(info) : formatText(info));
+}
+
+std::string Headless::formatText(const DrawInfo& info) const
+{
+    SYSTEMTIME now;
+    GetLocalTime(&now);
+
+    std::wstring line = std::format(L"{:02}:{:02}:{:02}", now.wHour, now.wMinute, now.wSecond);
+    for (const MetricValue *metric : {&info.cpuUsage, &info.memoryUsage, &info.networkUsage, &info.diskUsage, &info.diskIo, &info.topProcess})
+    {
+        line += L"  ";
+        line += metric->text;
+    }
+    line += L"\n";
+    return toUtf8(line);
+}
+
+std::string Headless::formatJson(const DrawInfo& info) const
+{
+    // epoch milliseconds; resolving the local time zone would cost more than the whole startup budget
+    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    return std::format(
+        "{{\"timestamp\":{},{},{},{},{},{},{},\"disks\":{}}}\n",
+        timestamp,
+        jsonMetric("cpu", info.cpuUsage),
+        jsonMetric("memory", info.memoryUsage),
+        jsonMetric("network", info.networkUsage),
+        jsonMetric("disk", info.diskUsage),
+        jsonMetric("diskIo", info.diskIo),
+        jsonMetric("process", info.topProcess),
+        jsonDisks(info.disks)
+    );
+}
+
+bool Headless::write(const std::string& text)
+{
+    size_t offset = 0;
+    while (offset < text.size())
+    {
+        DWORD written = 0;
+        if (!WriteFile(m_stdout, text.data() + offset, static_cast<DWORD>(text.size() - offset), &written, nullptr) || written == 0)
+        {
+            return false;
+        }
+        offset += written;
+    }
+    return true;
+}
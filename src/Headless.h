@@ -0,0 +1,37 @@
+#ifndef SRC_HEADLESS_H
+#define SRC_HEADLESS_H
+
+#include <windows.h>
+
+#include <string>
+
+#include "DrawInfo.h"
+#include "Options.h"
+#include "ResourceMonitor.h"
+
+// prints metrics to stdout without creating a window, a D3D device or any DirectWrite
+// object. samples come from the same ResourceMonitor the GUI uses.
+class Headless
+{
+public:
+    explicit Headless(const Options& options);
+
+    int run();
+
+private:
+    void sample();
+    bool print(const DrawInfo& info);
+
+    std::string formatText(const DrawInfo& info) const;
+    std::string formatJson(const DrawInfo& info) const;
+
+    // false once the reader has gone away, e.g. a pipe into head
+    bool write(const std::string& text);
+
+    Options m_options;
+    HANDLE m_stdout = nullptr;
+    ResourceMonitor m_resourceMonitor;
+};
+
+
+#endif //SRC_HEADLESS_H
\ No newline at end of file
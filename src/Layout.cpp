@@ -0,0 +1,57 @@
+#include "Layout.h"
+
+#include <algorithm>
+#include <cmath>
+
+LayoutEngine::LayoutEngine(std::span<const LayoutElement> layout)
+    : m_layout(layout)
+{
+    m_placed.reserve(m_layout.size());
+}
+
+void LayoutEngine::compute(SIZE client, float dpi)
+{
+    m_dpi = dpi;
+    float pixelsPerDip = dpi / 96.0f;
+    float width = static_cast<float>(client.cx) / pixelsPerDip;
+    float height = static_cast<float>(client.cy) / pixelsPerDip;
+
+    // edges on whole device pixels keep text and lines crisp at fractional scales
+    auto snap = [pixelsPerDip](float dip) {
+        return std::round(dip * pixelsPerDip) / pixelsPerDip;
+    };
+
+    m_placed.clear();
+    m_fleetCells.clear();
+    for (const LayoutElement& e : m_layout)
+    {
+        float left = e.anchor == Anchor::RIGHT ? width - e.x : e.x;
+        float right = e.width > 0.0f ? left + e.width : width;
+        float top = e.y;
+        float bottom = e.height > 0.0f ? top + e.height : height;
+
+        D2D1_RECT_F rect = D2D1::RectF(snap(left), snap(top), snap(right), snap(bottom));
+        m_placed.push_back(PlacedElement{
+            .element = e.element,
+            .rect = rect,
+        });
+
+        if (e.element != Element::FLEET_GRID)
+        {
+            continue;
+        }
+
+        // the same size the grid's text format is created at
+        float cellHeight = (e.fontSize > 0.0f ? e.fontSize : FONT_SIZE_FLEET) * FLEET_LINE_SPACING;
+        float gridWidth = rect.right - rect.left;
+        float gridHeight = rect.bottom - rect.top;
+        size_t columns = std::max<size_t>(1, gridWidth > 0.0f ? static_cast<size_t>(gridWidth / FLEET_CELL_WIDTH) : 0);
+        size_t rows = gridHeight > 0.0f ? static_cast<size_t>(gridHeight / cellHeight) : 0;
+        for (size_t i = 0; i < columns * rows; i++)
+        {
+            float x = rect.left + static_cast<float>(i % columns) * FLEET_CELL_WIDTH;
+            float y = rect.top + static_cast<float>(i / columns) * cellHeight;
+            m_fleetCells.push_back(D2D1::RectF(snap(x), snap(y), snap(x + FLEET_CELL_WIDTH), snap(y + cellHeight)));
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef SRC_LAYOUT_H
+#define SRC_LAYOUT_H
+
+#include <windows.h>
+#include <d2d1.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// in DIPs; the sizes the built-in layouts give their text elements
+constexpr float FONT_SIZE_TIMER = 128.0f;
+constexpr float FONT_SIZE_METRIC = 32.0f;
+constexpr float FONT_SIZE_FLEET = 14.0f;
+
+enum class Element : uint8_t
+{
+    TIMER,
+    CPU,
+    MEMORY,
+    NETWORK,
+    DISK,
+    DISK_IO,
+    PROCESS,
+    CPU_GRAPH,
+    FLEET_GRID,
+};
+
+// the window edge an element's x offset is measured from
+enum class Anchor : uint8_t
+{
+    LEFT,
+    // x is the distance from the right edge of the window to the element's left edge
+    RIGHT,
+};
+
+// one element of a declarative layout, in DIPs. a width or height of 0 stretches the
+// element to the right or bottom edge of the window. the element's text format is
+// created at fontSize; 0 for elements without text
+struct LayoutElement
+{
+    Element element;
+    Anchor anchor;
+    float x;
+    float y;
+    float width;
+    float height;
+    float fontSize;
+};
+
+// an element placed for a concrete client size and DPI, in DIPs snapped to device pixels
+struct PlacedElement
+{
+    Element element;
+    D2D1_RECT_F rect;
+};
+
+template <size_t N>
+constexpr std::array<LayoutElement, N + 1> withElement(const std::array<LayoutElement, N>& layout, const LayoutElement& element)
+{
+    std::array<LayoutElement, N + 1> result = {};
+    for (size_t i = 0; i < N; i++)
+    {
+        result[i] = layout[i];
+    }
+    result[N] = element;
+    return result;
+}
+
+// every element at most once, with non-negative geometry
+template <size_t N>
+constexpr bool validLayout(const std::array<LayoutElement, N>& layout)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        const LayoutElement& e = layout[i];
+        if (e.x < 0.0f || e.y < 0.0f || e.width < 0.0f || e.height < 0.0f || e.fontSize < 0.0f)
+        {
+            return false;
+        }
+        if (e.anchor == Anchor::RIGHT && e.width == 0.0f)
+        {
+            // would stretch from the right edge to itself
+            return false;
+        }
+        for (size_t j = i + 1; j < N; j++)
+        {
+            if (layout[j].element == e.element)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr float METRICS_TOP = FONT_SIZE_TIMER * 1.3f;
+// wide enough for the disk IO row, the longest
+constexpr float METRICS_WIDTH = 320.0f;
+constexpr float METRIC_ROW = FONT_SIZE_METRIC * 1.2f;
+constexpr float GRAPH_WIDTH = 240.0f;
+constexpr float GRAPH_MARGIN = 16.0f;
+constexpr float FLEET_MARGIN = 16.0f;
+constexpr float FLEET_CELL_WIDTH = 240.0f;
+// fleet cell height as a multiple of the grid's font size
+constexpr float FLEET_LINE_SPACING = 1.3f;
+
+// the clock over the whole window, metrics right-aligned below it, the CPU graph to
+// their left
+constexpr std::array<LayoutElement, 8> DEFAULT_LAYOUT = {{
+    {Element::TIMER, Anchor::LEFT, 0.0f, 0.0f, 0.0f, 0.0f, FONT_SIZE_TIMER},
+    {Element::CPU, Anchor::RIGHT, METRICS_WIDTH, METRICS_TOP, METRICS_WIDTH, METRIC_ROW, FONT_SIZE_METRIC},
+    {Element::MEMORY, Anchor::RIGHT, METRICS_WIDTH, METRICS_TOP + METRIC_ROW, METRICS_WIDTH, METRIC_ROW, FONT_SIZE_METRIC},
+    {Element::NETWORK, Anchor::RIGHT, METRICS_WIDTH, METRICS_TOP + METRIC_ROW * 2, METRICS_WIDTH, METRIC_ROW, FONT_SIZE_METRIC},
+    {Element::DISK, Anchor::RIGHT, METRICS_WIDTH, METRICS_TOP + METRIC_ROW * 3, METRICS_WIDTH, METRIC_ROW, FONT_SIZE_METRIC},
+    {Element::DISK_IO, Anchor::RIGHT, METRICS_WIDTH, METRICS_TOP + METRIC_ROW * 4, METRICS_WIDTH, METRIC_ROW, FONT_SIZE_METRIC},
+    {Element::PROCESS, Anchor::RIGHT, METRICS_WIDTH, METRICS_TOP + METRIC_ROW * 5, METRICS_WIDTH, METRIC_ROW, FONT_SIZE_METRIC},
+    {Element::CPU_GRAPH, Anchor::RIGHT, METRICS_WIDTH + GRAPH_MARGIN + GRAPH_WIDTH, METRICS_TOP, GRAPH_WIDTH, METRIC_ROW * 6, 0.0f},
+}};
+
+// aggregator mode: the local view plus a grid of hosts filling the rest of the window
+constexpr auto FLEET_LAYOUT = withElement(
+    DEFAULT_LAYOUT,
+    {Element::FLEET_GRID, Anchor::LEFT, 0.0f, METRICS_TOP + METRIC_ROW * 6 + FLEET_MARGIN, 0.0f, 0.0f, FONT_SIZE_FLEET}
+);
+
+static_assert(validLayout(DEFAULT_LAYOUT));
+static_assert(validLayout(FLEET_LAYOUT));
+
+// turns a declarative layout into placed rectangles. placement only changes with the
+// client size or DPI, so it is computed then and drawing just walks elements() and
+// fleetCells()
+class LayoutEngine
+{
+public:
+    // the layout must outlive the engine; the built-in layouts are static
+    explicit LayoutEngine(std::span<const LayoutElement> layout);
+
+    // client size in device pixels
+    void compute(SIZE client, float dpi);
+
+    std::span<const PlacedElement> elements() const
+    {
+        return m_placed;
+    }
+
+    // the whole cells that fit the fleet grid, row by row; empty without one
+    std::span<const D2D1_RECT_F> fleetCells() const
+    {
+        return m_fleetCells;
+    }
+
+    float dpi() const
+    {
+        return m_dpi;
+    }
+
+private:
+    std::span<const LayoutElement> m_layout;
+    std::vector<PlacedElement> m_placed;
+    std::vector<D2D1_RECT_F> m_fleetCells;
+    float m_dpi = 96.0f;
+};
+
+
+#endif //SRC_LAYOUT_H
\ No newline at end of file
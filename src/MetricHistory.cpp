@@ -0,0 +1,36 @@
+#include "MetricHistory.h"
+
+MetricHistory::MetricHistory(size_t capacity)
+    : m_points(capacity)
+{
+}
+
+void MetricHistory::push(std::chrono::steady_clock::time_point time, double value, std::chrono::steady_clock::duration nextInterval)
+{
+    append(HistoryPoint{
+        .time = time,
+        .value = value,
+        .nextInterval = nextInterval,
+        .gap = false,
+    });
+}
+
+void MetricHistory::pushGap(std::chrono::steady_clock::time_point time)
+{
+    append(HistoryPoint{
+        .time = time,
+        .value = 0.0,
+        .nextInterval = {},
+        .gap = true,
+    });
+}
+
+void MetricHistory::append(const HistoryPoint& point)
+{
+    m_points[m_head] = point;
+    m_head = (m_head + 1) % m_points.size();
+    if (m_size < m_points.size())
+    {
+        m_size++;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef SRC_METRICHISTORY_H
+#define SRC_METRICHISTORY_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+struct HistoryPoint
+{
+    std::chrono::steady_clock::time_point time;
+    double value = 0.0;
+    // interval the sampler chose after this sample
+    std::chrono::steady_clock::duration nextInterval{};
+    // no value could be taken at this time; graphs break the line here
+    bool gap = false;
+};
+
+// fixed-capacity ring of timestamped samples. samples are irregularly spaced, so
+// consumers must place them by time, not by index.
+class MetricHistory
+{
+public:
+    explicit MetricHistory(size_t capacity = 512);
+
+    void push(std::chrono::steady_clock::time_point time, double value, std::chrono::steady_clock::duration nextInterval);
+    void pushGap(std::chrono::steady_clock::time_point time);
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    // 0 is the oldest point
+    const HistoryPoint& operator[](size_t index) const
+    {
+        return m_points[(m_head + m_points.size() - m_size + index) % m_points.size()];
+    }
+
+private:
+    void append(const HistoryPoint& point);
+
+    std::vector<HistoryPoint> m_points;
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+
+#endif //SRC_METRICHISTORY_H
\ No newline at end of file
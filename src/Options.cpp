@@ -0,0 +1,159 @@
+#include "Options.h"
+
+#include "SnapshotCodec.h"
+#include "Utf8.h"
+
+#include <windows.h>
+#include <shellapi.h>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+std::wstring computerName()
+{
+    std::array<wchar_t, 256> name = {};
+    DWORD size = static_cast<DWORD>(name.size());
+    if (!GetComputerNameEx(ComputerNameDnsHostname, name.data(), &size))
+    {
+        return L"unknown";
+    }
+    return std::wstring(name.data(), size);
+}
+
+std::wstring parseHostName(const std::wstring& value)
+{
+    if (value.empty() || toUtf8(value).size() > SnapshotEncoder::MAX_HOST_NAME_SIZE)
+    {
+        throw std::invalid_argument("name must be 1 to 255 bytes of UTF-8");
+    }
+    return value;
+}
+
+uint16_t parsePort(const std::wstring& value)
+{
+    size_t end = 0;
+    unsigned long port = 0;
+    try
+    {
+        port = std::stoul(value, &end);
+    }
+    catch (const std::exception&)
+    {
+        throw std::invalid_argument("port must be a number");
+    }
+    if (end != value.size() || port == 0 || port > 65535)
+    {
+        throw std::invalid_argument("port must be between 1 and 65535");
+    }
+    return static_cast<uint16_t>(port);
+}
+
+long long parseInterval(const std::wstring& value)
+{
+    size_t end = 0;
+    long long ms = 0;
+    try
+    {
+        ms = std::stoll(value, &end);
+    }
+    catch (const std::exception&)
+    {
+        throw std::invalid_argument("interval must be a number of milliseconds");
+    }
+    if (end != value.size() || ms < 100)
+    {
+        // PDH rates over shorter windows are mostly noise
+        throw std::invalid_argument("interval must be at least 100 ms");
+    }
+    return ms;
+}
+}
+
+Options parseOptions()
+{
+    int argc = 0;
+    LPWSTR *argv = CommandLineToArgvW(GetCommandLine(), &argc);
+    if (argv == nullptr)
+    {
+        throw std::invalid_argument("failed to parse command line");
+    }
+    std::vector<std::wstring> args(argv + 1, argv + argc);
+    LocalFree(argv);
+
+    Options options;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        const std::wstring& arg = args[i];
+        auto value = [&]() -> const std::wstring& {
+            if (i + 1 >= args.size())
+            {
+                throw std::invalid_argument("missing value for option");
+            }
+            return args[++i];
+        };
+
+        if (arg == L"--publish")
+        {
+            options.publishTarget = value();
+        }
+        else if (arg == L"--aggregate")
+        {
+            options.aggregatePort = parsePort(value());
+        }
+        else if (arg == L"--name")
+        {
+            options.hostName = parseHostName(value());
+        }
+        else if (arg == L"--once")
+        {
+            options.once = true;
+        }
+        else if (arg == L"--watch")
+        {
+            options.watch = true;
+        }
+        else if (arg == L"--json")
+        {
+            options.json = true;
+        }
+        else if (arg == L"--interval")
+        {
+            options.interval = std::chrono::milliseconds(parseInterval(value()));
+        }
+        else if (arg == L"--sample-min")
+        {
+            options.sampleMin = std::chrono::milliseconds(parseInterval(value()));
+        }
+        else if (arg == L"--sample-max")
+        {
+            options.sampleMax = std::chrono::milliseconds(parseInterval(value()));
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option");
+        }
+    }
+
+    if (options.once && options.watch)
+    {
+        throw std::invalid_argument("--once and --watch are exclusive");
+    }
+    if (options.headless() && (options.publishTarget || options.aggregatePort))
+    {
+        // headless mode never opens the fleet sockets
+        throw std::invalid_argument("--publish and --aggregate need the window; they cannot be combined with --once, --watch or --json");
+    }
+    if (options.sampleMin > options.sampleMax)
+    {
+        throw std::invalid_argument("--sample-min must not exceed --sample-max");
+    }
+
+    if (options.hostName.empty())
+    {
+        options.hostName = computerName();
+    }
+    return options;
+}
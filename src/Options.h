@@ -0,0 +1,44 @@
+#ifndef SRC_OPTIONS_H
+#define SRC_OPTIONS_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+struct Options
+{
+    // --publish host:port  send every tick to an aggregator
+    std::optional<std::wstring> publishTarget;
+    // --aggregate port     receive from publishers and draw them as a grid
+    std::optional<uint16_t> aggregatePort;
+    // --name name          host name to publish as; defaults to the computer name
+    std::wstring hostName;
+
+    // headless: no window, no graphics device, records go to stdout
+    // --once               print one record from a correctly spaced pair of samples
+    bool once = false;
+    // --watch              print a record every interval until killed
+    bool watch = false;
+    // --json               newline-delimited JSON instead of text; implies --once without --watch
+    bool json = false;
+    // --interval ms        sampling interval for headless mode
+    std::chrono::milliseconds interval{1000};
+
+    // window mode samples each metric adaptively between these bounds
+    // --sample-min ms      fastest sampling interval while a metric is moving
+    std::chrono::milliseconds sampleMin{250};
+    // --sample-max ms      slowest sampling interval while a metric is flat
+    std::chrono::milliseconds sampleMax{2000};
+
+    bool headless() const
+    {
+        return once || watch || json;
+    }
+};
+
+// parses the process command line; throws std::invalid_argument on bad input
+Options parseOptions();
+
+
+#endif //SRC_OPTIONS_H
\ No newline at end of file
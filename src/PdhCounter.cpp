@@ -0,0 +1,155 @@
+#include "PdhCounter.h"
+
+#include <pdhmsg.h>
+
+#include <iostream>
+#include <stdexcept>
+
+PdhCounter::PdhCounter(const wchar_t *path, const wchar_t *pairedPath)
+{
+    PDH_STATUS status = PdhOpenQuery(nullptr, 0, &m_query);
+    if (status != ERROR_SUCCESS || m_query == nullptr)
+    {
+        throw std::runtime_error("failed to open PDH query");
+    }
+
+    status = PdhAddCounter(m_query, path, 0, &m_counter);
+    if (status != ERROR_SUCCESS || m_counter == nullptr)
+    {
+        PdhCloseQuery(m_query);
+        m_query = nullptr;
+        throw std::runtime_error("failed to add PDH counter");
+    }
+
+    if (pairedPath)
+    {
+        status = PdhAddCounter(m_query, pairedPath, 0, &m_pairedCounter);
+        if (status != ERROR_SUCCESS || m_pairedCounter == nullptr)
+        {
+            PdhCloseQuery(m_query);
+            m_query = nullptr;
+            throw std::runtime_error("failed to add PDH counter");
+        }
+    }
+}
+
+PdhCounter::~PdhCounter()
+{
+    if (m_query)
+    {
+        PdhCloseQuery(m_query);
+        m_query = nullptr;
+    }
+}
+
+std::optional<double> PdhCounter::sample()
+{
+    PDH_STATUS status = PdhCollectQueryData(m_query);
+    if (status != ERROR_SUCCESS)
+    {
+        std::cerr << "failed to collect query data: " << status << std::endl;
+        return std::nullopt;
+    }
+
+    DWORD bufSize = static_cast<DWORD>(m_buf.size());
+    DWORD itemCount = 0;
+    status = PdhGetFormattedCounterArray(
+        m_counter,
+        PDH_FMT_DOUBLE,
+        &bufSize,
+        &itemCount,
+        m_buf.empty() ? nullptr : reinterpret_cast<PPDH_FMT_COUNTERVALUE_ITEM>(m_buf.data())
+    );
+    if (status == PDH_MORE_DATA)
+    {
+        m_buf.resize(bufSize);
+        status = PdhGetFormattedCounterArray(
+            m_counter,
+            PDH_FMT_DOUBLE,
+            &bufSize,
+            &itemCount,
+            reinterpret_cast<PPDH_FMT_COUNTERVALUE_ITEM>(m_buf.data())
+        );
+    }
+    if (status != ERROR_SUCCESS || itemCount == 0)
+    {
+        return std::nullopt;
+    }
+
+    auto items = reinterpret_cast<PPDH_FMT_COUNTERVALUE_ITEM>(m_buf.data());
+    double sum = 0.0;
+    bool valid = false;
+    for (DWORD i = 0; i < itemCount; i++)
+    {
+        DWORD cstatus = items[i].FmtValue.CStatus;
+        if (cstatus == PDH_CSTATUS_VALID_DATA || cstatus == PDH_CSTATUS_NEW_DATA)
+        {
+            sum += items[i].FmtValue.doubleValue;
+            valid = true;
+        }
+    }
+
+    if (!valid)
+    {
+        return std::nullopt;
+    }
+    return sum;
+}
+
+const PDH_RAW_COUNTER_ITEM *PdhCounter::sampleRaw(DWORD& itemCount, const PDH_RAW_COUNTER_ITEM **paired)
+{
+    itemCount = 0;
+    if (paired)
+    {
+        *paired = nullptr;
+    }
+
+    PDH_STATUS status = PdhCollectQueryData(m_query);
+    if (status != ERROR_SUCCESS)
+    {
+        std::cerr << "failed to collect query data: " << status << std::endl;
+        return nullptr;
+    }
+
+    const PDH_RAW_COUNTER_ITEM *items = readRawArray(m_counter, m_buf, itemCount);
+    if (items && paired && m_pairedCounter)
+    {
+        DWORD pairedCount = 0;
+        const PDH_RAW_COUNTER_ITEM *pairedItems = readRawArray(m_pairedCounter, m_pairedBuf, pairedCount);
+        if (pairedCount == itemCount)
+        {
+            *paired = pairedItems;
+        }
+    }
+    return items;
+}
+
+const PDH_RAW_COUNTER_ITEM *PdhCounter::readRawArray(HCOUNTER counter, std::vector<std::byte>& buf, DWORD& itemCount)
+{
+    itemCount = 0;
+
+    DWORD bufSize = static_cast<DWORD>(buf.size());
+    PDH_STATUS status = PdhGetRawCounterArray(
+        counter,
+        &bufSize,
+        &itemCount,
+        buf.empty() ? nullptr : reinterpret_cast<PPDH_RAW_COUNTER_ITEM>(buf.data())
+    );
+    if (status == PDH_MORE_DATA)
+    {
+        buf.resize(bufSize);
+        status = PdhGetRawCounterArray(
+            counter,
+            &bufSize,
+            &itemCount,
+            reinterpret_cast<PPDH_RAW_COUNTER_ITEM>(buf.data())
+        );
+    }
+    if (status != ERROR_SUCCESS)
+    {
+        itemCount = 0;
+        return nullptr;
+    }
+
+    return reinterpret_cast<const PDH_RAW_COUNTER_ITEM *>(buf.data());
+}
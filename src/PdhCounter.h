@@ -0,0 +1,45 @@
+#ifndef SRC_PDHCOUNTER_H
+#define SRC_PDHCOUNTER_H
+
+#include <windows.h>
+#include <pdh.h>
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// a PDH query holding a single (possibly wildcard) counter, optionally with a second
+// counter of the same object that is collected together with it.
+// each provider owns its own query so a slow counter cannot block the others.
+class PdhCounter
+{
+public:
+    explicit PdhCounter(const wchar_t *path, const wchar_t *pairedPath = nullptr);
+    ~PdhCounter();
+
+    PdhCounter(const PdhCounter&) = delete;
+    PdhCounter& operator=(const PdhCounter&) = delete;
+
+    // collects a new sample and returns the sum over all instances.
+    // nullopt while the counter has no valid data, e.g. before the second sample of a rate
+    std::optional<double> sample();
+
+    // collects a new sample and returns the raw value of every instance.
+    // with a paired counter, paired receives its values from the same collection, or
+    // nullptr if they could not be read or the instance count differs; callers should
+    // still check that szName matches per item. the arrays stay valid until the next call
+    const PDH_RAW_COUNTER_ITEM *sampleRaw(DWORD& itemCount, const PDH_RAW_COUNTER_ITEM **paired = nullptr);
+
+private:
+    static const PDH_RAW_COUNTER_ITEM *readRawArray(HCOUNTER counter, std::vector<std::byte>& buf, DWORD& itemCount);
+
+    HQUERY m_query = nullptr;
+    HCOUNTER m_counter = nullptr;
+    HCOUNTER m_pairedCounter = nullptr;
+
+    std::vector<std::byte> m_buf;
+    std::vector<std::byte> m_pairedBuf;
+};
+
+
+#endif //SRC_PDHCOUNTER_H
\ No newline at end of file
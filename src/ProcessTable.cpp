@@ -0,0 +1,55 @@
+#include "ProcessTable.h"
+
+ProcessTable::ProcessTable(double processorCount)
+    : m_processorCount(std::max(1.0, processorCount))
+{
+}
+
+size_t ProcessTable::beginCollection(size_t count, uint64_t timestamp)
+{
+    std::sort(m_current.begin(), m_current.end());
+    std::swap(m_previous, m_current);
+    m_previousTimestamp = m_timestamp;
+    if (count > 0)
+    {
+        m_timestamp = timestamp;
+    }
+
+    // both keep their capacity, so a steady process count allocates nothing
+    size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_current.resize(count);
+    m_chunkTops.assign(chunks, ChunkTop{});
+    return chunks;
+}
+
+std::optional<ProcessUsage> ProcessTable::busiest() const
+{
+    auto best = std::max_element(m_chunkTops.begin(), m_chunkTops.end(), [](const ChunkTop& a, const ChunkTop& b) {
+        return a.usage < b.usage;
+    });
+    if (best == m_chunkTops.end() || best->usage < 0.0)
+    {
+        return std::nullopt;
+    }
+    return ProcessUsage{
+        .index = best->index,
+        .usage = best->usage,
+    };
+}
+
+uint64_t ProcessTable::hashName(const wchar_t *name)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (; *name; name++)
+    {
+        hash ^= static_cast<uint64_t>(*name);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool ProcessTable::isPseudoProcess(const wchar_t *name)
+{
+    return wcscmp(name, L"_Total") == 0 || wcscmp(name, L"Idle") == 0;
+}
\ No newline at end of file
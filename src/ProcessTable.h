@@ -0,0 +1,132 @@
+#ifndef SRC_PROCESSTABLE_H
+#define SRC_PROCESSTABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <optional>
+#include <vector>
+
+// one process of a collection, as read from the counters
+struct ProcessReading
+{
+    const wchar_t *name;
+    // the instance the PID was read from; only a matching name proves the arrays line up
+    const wchar_t *pidName;
+    uint32_t pid;
+    // 100 ns units
+    uint64_t cpuTime;
+};
+
+struct ProcessUsage
+{
+    size_t index;
+    // percent of all processors
+    double usage;
+};
+
+// per-process CPU usage between two collections of the process table. the table can
+// hold thousands of entries, so rates are computed in chunks of CHUNK_SIZE, each chunk
+// writing only its own slots; no counter API is involved, only the readings
+class ProcessTable
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    explicit ProcessTable(double processorCount);
+
+    // makes the last collection the lookup table for a new one of count processes,
+    // taken at timestamp (100 ns units). returns the number of chunks
+    size_t beginCollection(size_t count, uint64_t timestamp);
+
+    // read(i) returns the ProcessReading of item i. safe to call concurrently for
+    // different chunks
+    template <typename Read>
+    void computeChunk(size_t begin, size_t end, size_t chunk, Read read);
+
+    // nullopt if no process could be paired with the previous collection
+    std::optional<ProcessUsage> busiest() const;
+
+    static uint64_t hashName(const wchar_t *name);
+
+private:
+    // instance names repeat (dozens of svchost), so samples are paired across
+    // collections by PID. the name hash catches a PID reused by a different program
+    struct ProcessSample
+    {
+        uint32_t pid = 0;
+        uint64_t nameHash = 0;
+        uint64_t cpuTime = 0;
+
+        bool operator<(const ProcessSample& other) const
+        {
+            return pid != other.pid ? pid < other.pid : nameHash < other.nameHash;
+        }
+    };
+
+    struct ChunkTop
+    {
+        double usage = -1.0;
+        size_t index = 0;
+    };
+
+    static bool isPseudoProcess(const wchar_t *name);
+
+    double m_processorCount;
+    uint64_t m_timestamp = 0;
+    uint64_t m_previousTimestamp = 0;
+
+    // m_previous is sorted by PID so chunks can look up the last sample read-only
+    std::vector<ProcessSample> m_previous;
+    std::vector<ProcessSample> m_current;
+    std::vector<ChunkTop> m_chunkTops;
+};
+
+template <typename Read>
+void ProcessTable::computeChunk(size_t begin, size_t end, size_t chunk, Read read)
+{
+    double elapsed = static_cast<double>(m_timestamp - m_previousTimestamp);
+    bool hasPrevious = m_previousTimestamp != 0 && m_timestamp > m_previousTimestamp;
+
+    ChunkTop top;
+    for (size_t i = begin; i < end; i++)
+    {
+        ProcessReading reading = read(i);
+        ProcessSample current = {
+            .pid = reading.pid,
+            .nameHash = hashName(reading.name),
+            .cpuTime = reading.cpuTime,
+        };
+        m_current[i] = current;
+
+        if (!hasPrevious || isPseudoProcess(reading.name) || wcscmp(reading.name, reading.pidName) != 0)
+        {
+            continue;
+        }
+
+        auto previous = std::lower_bound(m_previous.begin(), m_previous.end(), current);
+        if (previous == m_previous.end()
+            || previous->pid != current.pid
+            || previous->nameHash != current.nameHash
+            || current.cpuTime < previous->cpuTime)
+        {
+            continue;
+        }
+
+        double usage = static_cast<double>(current.cpuTime - previous->cpuTime) / elapsed / m_processorCount * 100.0;
+        usage = std::min(usage, 100.0);
+        if (usage > top.usage)
+        {
+            top = ChunkTop{
+                .usage = usage,
+                .index = i,
+            };
+        }
+    }
+
+    m_chunkTops[chunk] = top;
+}
+
+
+#endif //SRC_PROCESSTABLE_H
\ No newline at end of file
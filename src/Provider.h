@@ -0,0 +1,149 @@
+#ifndef SRC_PROVIDER_H
+#define SRC_PROVIDER_H
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+#include "AdaptiveSampler.h"
+#include "DrawInfo.h"
+#include "Executor.h"
+#include "MetricHistory.h"
+#include "Task.h"
+#include "ThreadPool.h"
+
+// a metric source updated by a coroutine whenever its sampler says it is due.
+// blocking work is offloaded to the shared pool; the value itself is only
+// touched on the executor thread, so readers never need a lock.
+class Provider
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~Provider() = default;
+
+    void configureSampling(const SamplerConfig& config)
+    {
+        m_sampler = AdaptiveSampler(config);
+        m_config = config;
+    }
+
+    // idle and the sampler's interval has elapsed by the given time
+    bool due(Clock::time_point time) const
+    {
+        return m_task.done() && time >= m_nextDue;
+    }
+
+    // starts a new update unless the previous one is still in flight
+    void start(Executor& executor, ThreadPool& pool, Clock::time_point now)
+    {
+        if (!m_task.done())
+        {
+            return;
+        }
+
+        if (std::exception_ptr e = m_task.exception())
+        {
+            try
+            {
+                std::rethrow_exception(e);
+            }
+            catch (const std::exception& ex)
+            {
+                std::cerr << "provider update failed: " << ex.what() << std::endl;
+            }
+            catch (...)
+            {
+                std::cerr << "provider update failed" << std::endl;
+            }
+        }
+
+        m_startedAt = now;
+        m_published = false;
+        m_collecting = true;
+        m_task = update(executor, pool);
+        m_task.start();
+    }
+
+    // hands a finished update to the sampler and the history and schedules the next
+    // one. returns true if the update published a new value
+    bool collect()
+    {
+        if (!m_collecting || !m_task.done())
+        {
+            return false;
+        }
+        m_collecting = false;
+
+        // a sample that started a whole interval late means the process was stalled or
+        // suspended; nothing is known about the time in between
+        if (m_history.size() > 0 && m_startedAt > m_nextDue + m_interval)
+        {
+            m_history.pushGap(m_nextDue);
+        }
+
+        if (!m_published)
+        {
+            // rate counters need a second sample; failures retry at the fastest rate
+            m_history.pushGap(m_startedAt);
+            m_interval = m_config.minInterval;
+        }
+        else
+        {
+            m_interval = m_sampler.record(m_value.value);
+            m_history.push(m_startedAt, m_value.value, m_interval);
+        }
+        m_nextDue = m_startedAt + m_interval;
+        return m_published;
+    }
+
+    bool running() const
+    {
+        return !m_task.done();
+    }
+
+    // keeps the previous value but flags it as out of date
+    void markStale()
+    {
+        m_value.stale = true;
+    }
+
+    const MetricValue& value() const
+    {
+        return m_value;
+    }
+
+    const MetricHistory& history() const
+    {
+        return m_history;
+    }
+
+protected:
+    virtual Task update(Executor& executor, ThreadPool& pool) = 0;
+
+    // called by update() with each new sample
+    void publish(MetricValue value)
+    {
+        m_value = std::move(value);
+        m_published = true;
+    }
+
+    MetricValue m_value;
+
+private:
+    Task m_task;
+
+    SamplerConfig m_config;
+    AdaptiveSampler m_sampler;
+    MetricHistory m_history;
+
+    Clock::time_point m_startedAt;
+    Clock::time_point m_nextDue;
+    Clock::duration m_interval{};
+    bool m_published = false;
+    bool m_collecting = false;
+};
+
+
+#endif //SRC_PROVIDER_H
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include "Providers.h"
+
+#include <algorithm>
+#include <format>
+#include <optional>
+#include <string_view>
+
+namespace
+{
+std::wstring formatProcessorTime(double value)
+{
+    return std::format(L"CPU: {:>5.1f}%", value);
+}
+
+std::wstring formatMemoryBytes(long long bytes)
+{
+    constexpr long long KB = 1024;
+    constexpr long long MB = KB * 1024;
+    constexpr long long GB = MB * 1024;
+
+    if (bytes >= GB)
+    {
+        return std::format(L"mem: {:>5.1f}GB", static_cast<double>(bytes) / GB);
+    }
+    else if (bytes >= MB)
+    {
+        return std::format(L"mem: {:>5.1f}MB", static_cast<double>(bytes) / MB);
+    }
+    else
+    {
+        return std::format(L"mem: {:>5.1f}KB", static_cast<double>(bytes) / KB);
+    }
+}
+
+std::wstring formatNetworkBytesPerSec(long long bytesPerSec)
+{
+    constexpr long long Kb = 128;
+    constexpr long long Mb = Kb * 1024;
+    constexpr long long Gb = Mb * 1024;
+
+    if (bytesPerSec >= Gb)
+    {
+        return std::format(L"net: {:>5.1f}Gbps", static_cast<double>(bytesPerSec) / Gb);
+    }
+    else if (bytesPerSec >= Mb)
+    {
+        return std::format(L"net: {:>5.1f}Mbps", static_cast<double>(bytesPerSec) / Mb);
+    }
+    else
+    {
+        return std::format(L"net: {:>5.1f}Kbps", static_cast<double>(bytesPerSec) / Kb);
+    }
+}
+
+std::wstring formatDiskBytesPerSec(double bytesPerSec)
+{
+    constexpr double KB = 1024;
+    constexpr double MB = KB * 1024;
+    constexpr double GB = MB * 1024;
+
+    if (bytesPerSec >= GB)
+    {
+        return std::format(L"dsk: {:>5.1f}GB/s", bytesPerSec / GB);
+    }
+    else if (bytesPerSec >= MB)
+    {
+        return std::format(L"dsk: {:>5.1f}MB/s", bytesPerSec / MB);
+    }
+    else
+    {
+        return std::format(L"dsk: {:>5.1f}KB/s", bytesPerSec / KB);
+    }
+}
+
+std::wstring formatDiskIo(double iops, double queueLength, double latencyMs)
+{
+    std::wstring ops = iops >= 10000.0
+        ? std::format(L"{:>3.0f}k", iops / 1000.0)
+        : std::format(L"{:>4.0f}", iops);
+    return std::format(L"io: {} q{:.1f} {:.0f}ms", ops, queueLength, latencyMs);
+}
+
+std::wstring formatTopProcess(std::wstring_view name, double usage)
+{
+    return std::format(L"{:<8.8} {:>5.1f}%", name, usage);
+}
+
+}
+
+std::wstring metricPlaceholder(std::wstring_view label)
+{
+    return std::format(L"{}: {:>5}", label, L"--.-");
+}
+
+CpuProvider::CpuProvider()
+    : m_counter(COUNTER_PATH)
+{
+    m_value.text = metricPlaceholder(L"CPU");
+}
+
+Task CpuProvider::update(Executor& executor, ThreadPool& pool)
+{
+    std::optional<double> usage = co_await executor.offload(pool, [this] { return m_counter.sample(); });
+    if (!usage)
+    {
+        co_return;
+    }
+
+    publish(MetricValue{
+        .text = formatProcessorTime(*usage),
+        .value = *usage,
+        .valid = true,
+        .stale = false,
+    });
+}
+
+MemoryProvider::MemoryProvider()
+    : m_counter(COUNTER_PATH)
+{
+    m_value.text = metricPlaceholder(L"mem");
+}
+
+Task MemoryProvider::update(Executor& executor, ThreadPool& pool)
+{
+    std::optional<double> bytes = co_await executor.offload(pool, [this] { return m_counter.sample(); });
+    if (!bytes)
+    {
+        co_return;
+    }
+
+    publish(MetricValue{
+        .text = formatMemoryBytes(static_cast<long long>(*bytes)),
+        .value = *bytes,
+        .valid = true,
+        .stale = false,
+    });
+}
+
+NetworkProvider::NetworkProvider()
+    : m_counter(COUNTER_PATH)
+{
+    m_value.text = metricPlaceholder(L"net");
+}
+
+Task NetworkProvider::update(Executor& executor, ThreadPool& pool)
+{
+    std::optional<double> bytesPerSec = co_await executor.offload(pool, [this] { return m_counter.sample(); });
+    if (!bytesPerSec)
+    {
+        co_return;
+    }
+
+    publish(MetricValue{
+        .text = formatNetworkBytesPerSec(static_cast<long long>(*bytesPerSec)),
+        .value = *bytesPerSec,
+        .valid = true,
+        .stale = false,
+    });
+}
+
+DiskProvider::DiskProvider()
+{
+    m_value.text = metricPlaceholder(L"dsk");
+    m_io.text = metricPlaceholder(L"io");
+}
+
+MetricValue DiskProvider::io() const
+{
+    MetricValue io = m_io;
+    io.stale = m_value.stale;
+    return io;
+}
+
+Task DiskProvider::update(Executor& executor, ThreadPool& pool)
+{
+    std::optional<double> bytesPerSec = co_await executor.offload(pool, [this] {
+        m_monitor.sample();
+        return m_monitor.hasRates() ? std::optional(m_monitor.totalBytesPerSec()) : std::nullopt;
+    });
+    if (!bytesPerSec)
+    {
+        co_return;
+    }
+
+    // the monitor is idle until the next update, so its devices can be read here
+    m_devices.clear();
+    for (const DiskDevice& device : m_monitor.devices())
+    {
+        if (device.physical)
+        {
+            m_devices.push_back(device);
+        }
+    }
+
+    auto iops = [](const DiskDevice& device) {
+        return device.readIops + device.writeIops;
+    };
+    auto busiest = std::ranges::max_element(m_devices, {}, iops);
+    if (busiest != m_devices.end())
+    {
+        m_io = MetricValue{
+            .text = formatDiskIo(iops(*busiest), busiest->queueLength, busiest->latencyMs),
+            .value = iops(*busiest),
+            .valid = true,
+            .stale = false,
+        };
+    }
+
+    publish(MetricValue{
+        .text = formatDiskBytesPerSec(*bytesPerSec),
+        .value = *bytesPerSec,
+        .valid = true,
+        .stale = false,
+    });
+}
+
+ProcessProvider::ProcessProvider()
+    : m_counter(COUNTER_PATH, PID_COUNTER_PATH),
+      m_table(static_cast<double>(GetActiveProcessorCount(ALL_PROCESSOR_GROUPS)))
+{
+    m_value.text = metricPlaceholder(L"top");
+}
+
+Task ProcessProvider::update(Executor& executor, ThreadPool& pool)
+{
+    DWORD itemCount = co_await executor.offload(pool, [this] { return collect(); });
+
+    co_await executor.parallelFor(pool, itemCount, ProcessTable::CHUNK_SIZE, [this](size_t begin, size_t end, size_t chunk) {
+        m_table.computeChunk(begin, end, chunk, [this](size_t i) {
+            return ProcessReading{
+                .name = m_items[i].szName,
+                .pidName = m_pids[i].szName,
+                .pid = static_cast<uint32_t>(m_pids[i].RawValue.FirstValue),
+                .cpuTime = static_cast<uint64_t>(m_items[i].RawValue.FirstValue),
+            };
+        });
+    });
+
+    std::optional<ProcessUsage> busiest = m_table.busiest();
+    if (!busiest)
+    {
+        co_return;
+    }
+
+    publish(MetricValue{
+        .text = formatTopProcess(m_items[busiest->index].szName, busiest->usage),
+        .value = busiest->usage,
+        .valid = true,
+        .stale = false,
+    });
+}
+
+DWORD ProcessProvider::collect()
+{
+    DWORD itemCount = 0;
+    m_items = m_counter.sampleRaw(itemCount, &m_pids);
+    if (!m_items || !m_pids)
+    {
+        // without PIDs duplicate names cannot be told apart; skip this tick
+        m_items = nullptr;
+        itemCount = 0;
+    }
+
+    uint64_t timestamp = 0;
+    if (itemCount > 0)
+    {
+        const FILETIME& ts = m_items[0].RawValue.TimeStamp;
+        timestamp = (static_cast<uint64_t>(ts.dwHighDateTime) << 32) | ts.dwLowDateTime;
+    }
+    m_table.beginCollection(itemCount, timestamp);
+    return itemCount;
+}
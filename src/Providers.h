@@ -0,0 +1,111 @@
+#ifndef SRC_PROVIDERS_H
+#define SRC_PROVIDERS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DiskMonitor.h"
+#include "PdhCounter.h"
+#include "ProcessTable.h"
+#include "Provider.h"
+
+// text shown until a provider has its first valid sample; rates need two
+std::wstring metricPlaceholder(std::wstring_view label);
+
+class CpuProvider : public Provider
+{
+public:
+    CpuProvider();
+
+protected:
+    Task update(Executor& executor, ThreadPool& pool) override;
+
+private:
+    const wchar_t *COUNTER_PATH = L"\\Processor(_Total)\\% Processor Time";
+
+    PdhCounter m_counter;
+};
+
+class MemoryProvider : public Provider
+{
+public:
+    MemoryProvider();
+
+protected:
+    Task update(Executor& executor, ThreadPool& pool) override;
+
+private:
+    const wchar_t *COUNTER_PATH = L"\\Memory\\Committed Bytes";
+
+    PdhCounter m_counter;
+};
+
+class NetworkProvider : public Provider
+{
+public:
+    NetworkProvider();
+
+protected:
+    Task update(Executor& executor, ThreadPool& pool) override;
+
+private:
+    const wchar_t *COUNTER_PATH = L"\\Network Interface(*)\\Bytes Received/sec";
+
+    PdhCounter m_counter;
+};
+
+// total throughput is the sampled value; the busiest disk's IOPS, queue length and
+// latency and every physical disk's figures come with it
+class DiskProvider : public Provider
+{
+public:
+    DiskProvider();
+
+    // IOPS of the busiest physical disk; the text adds its queue length and latency
+    MetricValue io() const;
+
+    // physical disks as of the last update
+    const std::vector<DiskDevice>& devices() const
+    {
+        return m_devices;
+    }
+
+protected:
+    Task update(Executor& executor, ThreadPool& pool) override;
+
+private:
+    DiskMonitor m_monitor;
+
+    // copied from m_monitor on the executor thread, so readers need no lock
+    std::vector<DiskDevice> m_devices;
+    MetricValue m_io;
+};
+
+// busiest process by CPU time. the process table can hold thousands of entries, so
+// rates are computed in chunks on the pool; see ProcessTable
+class ProcessProvider : public Provider
+{
+public:
+    ProcessProvider();
+
+protected:
+    Task update(Executor& executor, ThreadPool& pool) override;
+
+private:
+    DWORD collect();
+
+    const wchar_t *COUNTER_PATH = L"\\Process(*)\\% Processor Time";
+    const wchar_t *PID_COUNTER_PATH = L"\\Process(*)\\ID Process";
+
+    PdhCounter m_counter;
+    ProcessTable m_table;
+
+    const PDH_RAW_COUNTER_ITEM *m_items = nullptr;
+    // same instances as m_items, from the same collection
+    const PDH_RAW_COUNTER_ITEM *m_pids = nullptr;
+};
+
+
+#endif //SRC_PROVIDERS_H
\ No newline at end of file
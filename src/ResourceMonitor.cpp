@@ -1,223 +1,112 @@
 #include "ResourceMonitor.h"
 
-#include <stdexcept>
-#include <iostream>
-#include <format>
-#include <vector>
+#include <algorithm>
 
-namespace
-{
-std::wstring formatProcessorTime(double value)
-{
-    return std::format(L"CPU: {:>5.1f}%", value);
-}
+#include "Providers.h"
 
-std::wstring formatMemoryBytes(long long bytes)
+ResourceMonitor::ResourceMonitor(std::function<void()> wake, const SamplerConfig& sampling)
+    : m_sampling(sampling), m_executor(std::move(wake))
 {
-    constexpr long long KB = 1024;
-    constexpr long long MB = KB * 1024;
-    constexpr long long GB = MB * 1024;
+    m_cpu = std::make_unique<CpuProvider>();
+    m_memory = std::make_unique<MemoryProvider>();
+    m_network = std::make_unique<NetworkProvider>();
+    m_disk = std::make_unique<DiskProvider>();
+    m_process = std::make_unique<ProcessProvider>();
 
-    if (bytes >= GB)
-    {
-        return std::format(L"mem: {:>5.1f}GB", static_cast<double>(bytes) / GB);
-    }
-    else if (bytes >= MB)
-    {
-        return std::format(L"mem: {:>5.1f}MB", static_cast<double>(bytes) / MB);
-    }
-    else
+    m_providers = {m_cpu.get(), m_memory.get(), m_network.get(), m_disk.get(), m_process.get()};
+    for (Provider *provider : m_providers)
     {
-        return std::format(L"mem: {:>5.1f}KB", static_cast<double>(bytes) / KB);
+        provider->configureSampling(m_sampling);
     }
 }
 
-std::wstring formatNetworkBytesPerSec(long long bytesPerSec)
+ResourceMonitor::~ResourceMonitor()
 {
-    constexpr long long Kb = 128;
-    constexpr long long Mb = Kb * 1024;
-    constexpr long long Gb = Mb * 1024;
-
-    if (bytesPerSec >= Gb)
-    {
-        return std::format(L"net: {:>5.1f}Gbps", static_cast<double>(bytesPerSec) / Gb);
-    }
-    else if (bytesPerSec >= Mb)
-    {
-        return std::format(L"net: {:>5.1f}Mbps", static_cast<double>(bytesPerSec) / Mb);
-    }
-    else
-    {
-        return std::format(L"net: {:>5.1f}Kbps", static_cast<double>(bytesPerSec) / Kb);
-    }
-}
-
+    // in-flight jobs reference provider state; stop them before any provider is destroyed
+    m_pool.stop();
 }
 
-ResourceMonitor::ResourceMonitor()
+bool ResourceMonitor::tick()
 {
-    PDH_STATUS status = PdhOpenQuery(nullptr, 0, &m_query);
-    if (status != ERROR_SUCCESS || m_query == nullptr)
-    {
-        throw std::runtime_error("failed to open PDH query");
-    }
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = now + TICK_DEADLINE;
+    // timers fire a scheduler quantum late or early; sample anything due within half
+    // the shortest interval now instead of a whole timer period later
+    auto horizon = now + m_sampling.minInterval / 2;
 
-    status = PdhAddCounter(m_query, CPU_COUNTER_PATH, 0, &m_cpuCounter);
-    if (status != ERROR_SUCCESS || m_cpuCounter == nullptr)
+    // a provider still running from an earlier tick is not due, so it is never waited
+    // on again; it finishes through runReady()
+    m_started.clear();
+    for (Provider *provider : m_providers)
     {
-        throw std::runtime_error("failed to add CPU counter");
+        if (provider->due(horizon))
+        {
+            provider->start(m_executor, m_pool, now);
+            m_started.push_back(provider);
+        }
     }
-
-    status = PdhAddCounter(m_query, MEMORY_COUNTER_PATH, 0, &m_memoryCounter);
-    if (status != ERROR_SUCCESS || m_memoryCounter == nullptr)
+    if (m_started.empty())
     {
-        throw std::runtime_error("failed to add Memory counter");
+        return false;
     }
 
-    status = PdhAddCounter(m_query, NETWORK_COUNTER_PATH, 0, &m_networkCounter);
-    if (status != ERROR_SUCCESS || m_networkCounter == nullptr)
+    bool finished = m_executor.runUntil(deadline, [this] {
+        return std::ranges::none_of(m_started, &Provider::running);
+    });
+    if (!finished)
     {
-        throw std::runtime_error("failed to add Network counter");
+        for (Provider *provider : m_started)
+        {
+            if (provider->running())
+            {
+                provider->markStale();
+            }
+        }
     }
+
+    return collect() || !finished;
 }
 
-ResourceMonitor::~ResourceMonitor()
+bool ResourceMonitor::runReady()
 {
-    if (m_query)
-    {
-        PdhCloseQuery(m_query);
-        m_query = nullptr;
-    }
+    bool resumed = m_executor.runReady() > 0;
+    collect();
+    return resumed;
 }
 
-DrawInfo ResourceMonitor::collect() const
+bool ResourceMonitor::collect()
 {
-    if (!m_query || !m_cpuCounter || !m_memoryCounter || !m_networkCounter)
-    {
-        return DrawInfo{
-            .timeString = L"",
-            .cpuUsage = formatProcessorTime(0),
-            .memoryUsage = formatMemoryBytes(0),
-            .networkUsage = formatNetworkBytesPerSec(0),
-        };
-    }
-
-    PDH_STATUS status = PdhCollectQueryData(m_query);
-    if (status != ERROR_SUCCESS)
+    bool published = false;
+    for (Provider *provider : m_providers)
     {
-        std::cerr << "failed to collect query data: " << status << std::endl;
-        return DrawInfo{
-            .timeString = L"",
-            .cpuUsage = formatProcessorTime(0),
-            .memoryUsage = formatMemoryBytes(0),
-            .networkUsage = formatNetworkBytesPerSec(0),
-        };
+        published |= provider->collect();
     }
+    return published;
+}
 
-    DWORD bufSize = 0;
-    DWORD itemCount = 0;
-
-    // CPU
-    PdhGetFormattedCounterArray(
-        m_cpuCounter,
-        PDH_FMT_DOUBLE,
-        &bufSize,
-        &itemCount,
-        nullptr
-    );
-    if (bufSize == 0 || itemCount == 0)
-    {
-        return DrawInfo{
-            .timeString = L"",
-            .cpuUsage = formatProcessorTime(0),
-            .memoryUsage = formatMemoryBytes(0),
-            .networkUsage = formatNetworkBytesPerSec(0),
-        };
-    }
-
-    std::vector<std::byte> buf(bufSize);
-    PPDH_FMT_COUNTERVALUE_ITEM items = reinterpret_cast<PPDH_FMT_COUNTERVALUE_ITEM_W>(buf.data());
-    PdhGetFormattedCounterArray(
-        m_cpuCounter,
-        PDH_FMT_DOUBLE,
-        &bufSize,
-        &itemCount,
-        items
-    );
-    double cpuUsage = items[0].FmtValue.doubleValue;
-
-    // Memory
-    bufSize = 0;
-    itemCount = 0;
-    PdhGetFormattedCounterArray(
-        m_memoryCounter,
-        PDH_FMT_LARGE,
-        &bufSize,
-        &itemCount,
-        nullptr
-    );
-    if (bufSize == 0 || itemCount == 0)
-    {
-        return DrawInfo{
-            .timeString = L"",
-            .cpuUsage = formatProcessorTime(cpuUsage),
-            .memoryUsage = formatMemoryBytes(0),
-            .networkUsage = formatNetworkBytesPerSec(0),
-        };
-    }
-
-    std::vector<std::byte> bufMem(bufSize);
-    PPDH_FMT_COUNTERVALUE_ITEM itemsMem = reinterpret_cast<PPDH_FMT_COUNTERVALUE_ITEM_W>(bufMem.data());
-    PdhGetFormattedCounterArray(
-        m_memoryCounter,
-        PDH_FMT_LARGE,
-        &bufSize,
-        &itemCount,
-        itemsMem
-    );
-    long long memoryBytes = itemsMem[0].FmtValue.largeValue;
-
-    // Network
-    bufSize = 0;
-    itemCount = 0;
-    PdhGetFormattedCounterArray(
-        m_networkCounter,
-        PDH_FMT_LARGE,
-        &bufSize,
-        &itemCount,
-        nullptr
-    );
-    if (bufSize == 0 || itemCount == 0)
-    {
-        return DrawInfo{
-            .timeString = L"",
-            .cpuUsage = formatProcessorTime(cpuUsage),
-            .memoryUsage = formatMemoryBytes(memoryBytes),
-            .networkUsage = formatNetworkBytesPerSec(0),
-        };
-    }
-
-    std::vector<std::byte> bufNet(bufSize);
-    PPDH_FMT_COUNTERVALUE_ITEM itemsNet = reinterpret_cast<PPDH_FMT_COUNTERVALUE_ITEM_W>(bufNet.data());
-    PdhGetFormattedCounterArray(
-        m_networkCounter,
-        PDH_FMT_LARGE,
-        &bufSize,
-        &itemCount,
-        itemsNet
-    );
-    long long networkBytesPerSec = 0;
-    for (DWORD i = 0; i < itemCount; i++)
-    {
-        networkBytesPerSec += itemsNet[i].FmtValue.largeValue;
-    }
-
-
+DrawInfo ResourceMonitor::snapshot() const
+{
     return DrawInfo{
         .timeString = L"",
-        .cpuUsage = formatProcessorTime(cpuUsage),
-        .memoryUsage = formatMemoryBytes(memoryBytes),
-        .networkUsage = formatNetworkBytesPerSec(networkBytesPerSec),
+        .cpuUsage = m_cpu->value(),
+        .memoryUsage = m_memory->value(),
+        .networkUsage = m_network->value(),
+        .diskUsage = m_disk->value(),
+        .diskIo = m_disk->io(),
+        .topProcess = m_process->value(),
+        .disks = m_disk->devices(),
     };
 }
 
+DrawInfo ResourceMonitor::placeholderSnapshot()
+{
+    return DrawInfo{
+        .timeString = L"",
+        .cpuUsage = {.text = metricPlaceholder(L"CPU")},
+        .memoryUsage = {.text = metricPlaceholder(L"mem")},
+        .networkUsage = {.text = metricPlaceholder(L"net")},
+        .diskUsage = {.text = metricPlaceholder(L"dsk")},
+        .diskIo = {.text = metricPlaceholder(L"io")},
+        .topProcess = {.text = metricPlaceholder(L"top")},
+    };
+}
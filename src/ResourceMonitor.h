@@ -1,28 +1,67 @@
 #ifndef SRC_RESOURCEMONITOR_H
 #define SRC_RESOURCEMONITOR_H
 
-#include <windows.h>
-#include <pdh.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
 
+#include "AdaptiveSampler.h"
 #include "DrawInfo.h"
+#include "Executor.h"
+#include "MetricHistory.h"
+#include "Provider.h"
+#include "ThreadPool.h"
+
+class DiskProvider;
 
 class ResourceMonitor
 {
 public:
-    ResourceMonitor();
+    // wake is called from any thread when a late provider finishes; the owner should
+    // call runReady() on its own thread in response. each provider adapts its own
+    // sampling interval within the bounds of sampling; call tick() at least every
+    // sampling.minInterval
+    explicit ResourceMonitor(std::function<void()> wake = nullptr, const SamplerConfig& sampling = {});
     ~ResourceMonitor();
 
-    DrawInfo collect() const;
+    // starts every provider that is due and waits for them at most until the tick
+    // deadline. providers that miss it keep their previous value, marked stale.
+    // returns true if the snapshot changed
+    bool tick();
+
+    // resumes providers that finished after their deadline. returns true if any did
+    bool runReady();
+
+    DrawInfo snapshot() const;
+
+    const MetricHistory& cpuHistory() const
+    {
+        return m_cpu->history();
+    }
+
+    // what to draw while the monitor itself is still being constructed
+    static DrawInfo placeholderSnapshot();
 
 private:
-    HQUERY m_query = nullptr;
-    HCOUNTER m_cpuCounter = nullptr;
-    HCOUNTER m_memoryCounter = nullptr;
-    HCOUNTER m_networkCounter = nullptr;
-
-    const wchar_t *CPU_COUNTER_PATH = L"\\Processor(_Total)\\% Processor Time";
-    const wchar_t *MEMORY_COUNTER_PATH = L"\\Memory\\Committed Bytes";
-    const wchar_t *NETWORK_COUNTER_PATH = L"\\Network Interface(*)\\Bytes Received/sec";
+    // feeds finished updates to their samplers; true if any published a new value
+    bool collect();
+
+    SamplerConfig m_sampling;
+    Executor m_executor;
+    ThreadPool m_pool;
+
+    std::unique_ptr<Provider> m_cpu;
+    std::unique_ptr<Provider> m_memory;
+    std::unique_ptr<Provider> m_network;
+    std::unique_ptr<DiskProvider> m_disk;
+    std::unique_ptr<Provider> m_process;
+
+    std::vector<Provider*> m_providers;
+    // the providers started by the current tick; only these are waited for
+    std::vector<Provider*> m_started;
+
+    const std::chrono::milliseconds TICK_DEADLINE{100};
 };
 
 
@@ -0,0 +1,221 @@
+#include "SnapshotCodec.h"
+
+namespace
+{
+constexpr uint8_t FRAME_MAGIC = 0xC7;
+constexpr uint8_t FRAME_VERSION = 2;
+constexpr uint8_t FLAG_KEYFRAME = 0x01;
+
+// three header bytes, host id, sequence and mask varints, every metric's 64-bit
+// zigzag varint and the name length varint
+constexpr size_t MAX_KEYFRAME_OVERHEAD = 3 + 5 + 5 + 5 + METRIC_COUNT * 10 + 2;
+static_assert(MAX_KEYFRAME_OVERHEAD + SnapshotEncoder::MAX_HOST_NAME_SIZE <= SnapshotEncoder::MAX_FRAME_SIZE);
+
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class FrameWriter
+{
+public:
+    explicit FrameWriter(std::span<uint8_t> out)
+        : m_out(out)
+    {
+    }
+
+    void byte(uint8_t value)
+    {
+        if (m_offset < m_out.size())
+        {
+            m_out[m_offset] = value;
+        }
+        m_offset++;
+    }
+
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            byte(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        byte(static_cast<uint8_t>(value));
+    }
+
+    // 0 if anything was cut off
+    size_t size() const
+    {
+        return m_offset <= m_out.size() ? m_offset : 0;
+    }
+
+private:
+    std::span<uint8_t> m_out;
+    size_t m_offset = 0;
+};
+}
+
+SnapshotEncoder::SnapshotEncoder(uint32_t hostId, std::string hostName)
+    : m_hostId(hostId), m_hostName(std::move(hostName))
+{
+}
+
+size_t SnapshotEncoder::encode(const MetricTable& table, std::span<uint8_t> out)
+{
+    bool keyframe = m_sequence % KEYFRAME_INTERVAL == 0;
+
+    FrameWriter writer(out);
+    writer.byte(FRAME_MAGIC);
+    writer.byte(FRAME_VERSION);
+    writer.byte(keyframe ? FLAG_KEYFRAME : 0);
+    writer.varint(m_hostId);
+    writer.varint(m_sequence);
+    writer.varint(table.validMask);
+
+    MetricTable current;
+    for (size_t i = 0; i < METRIC_COUNT; i++)
+    {
+        auto id = static_cast<MetricId>(i);
+        if (!table.valid(id))
+        {
+            continue;
+        }
+
+        current.set(id, table.values[i]);
+        int64_t base = keyframe ? 0 : m_keyframe.values[i];
+        writer.varint(zigzag(table.values[i] - base));
+    }
+
+    if (keyframe)
+    {
+        writer.varint(m_hostName.size());
+        for (char c : m_hostName)
+        {
+            writer.byte(static_cast<uint8_t>(c));
+        }
+    }
+
+    size_t size = writer.size();
+    if (size > 0)
+    {
+        if (keyframe)
+        {
+            m_keyframe = current;
+        }
+        m_sequence++;
+    }
+    return size;
+}
+
+FrameReader::FrameReader(std::span<const uint8_t> data)
+    : m_data(data)
+{
+}
+
+bool FrameReader::readVarint(uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (m_offset >= m_data.size())
+        {
+            return false;
+        }
+        uint8_t b = m_data[m_offset++];
+        value |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FrameReader::readHeader(FrameHeader& header)
+{
+    if (m_data.size() < 3 || m_data[0] != FRAME_MAGIC || m_data[1] != FRAME_VERSION)
+    {
+        return false;
+    }
+    m_keyframe = (m_data[2] & FLAG_KEYFRAME) != 0;
+    m_offset = 3;
+
+    uint64_t hostId = 0;
+    uint64_t sequence = 0;
+    if (!readVarint(hostId) || !readVarint(sequence))
+    {
+        return false;
+    }
+
+    header = FrameHeader{
+        .hostId = static_cast<uint32_t>(hostId),
+        .sequence = static_cast<uint32_t>(sequence),
+        .keyframe = m_keyframe,
+    };
+    return true;
+}
+
+bool FrameReader::readValues(const MetricTable& keyframe, MetricTable& table)
+{
+    uint64_t mask = 0;
+    if (!readVarint(mask) || (mask >> METRIC_COUNT) != 0)
+    {
+        return false;
+    }
+
+    MetricTable result;
+    for (size_t i = 0; i < METRIC_COUNT; i++)
+    {
+        auto id = static_cast<MetricId>(i);
+        if (((mask >> i) & 1u) == 0)
+        {
+            continue;
+        }
+
+        uint64_t encoded = 0;
+        if (!readVarint(encoded))
+        {
+            return false;
+        }
+        int64_t base = m_keyframe ? 0 : keyframe.values[i];
+        result.set(id, base + unzigzag(encoded));
+    }
+
+    table = result;
+    return true;
+}
+
+bool FrameReader::readHostName(std::string& name)
+{
+    if (!m_keyframe)
+    {
+        return false;
+    }
+
+    uint64_t length = 0;
+    if (!readVarint(length) || length > m_data.size() - m_offset)
+    {
+        return false;
+    }
+
+    name.assign(reinterpret_cast<const char *>(m_data.data() + m_offset), static_cast<size_t>(length));
+    m_offset += static_cast<size_t>(length);
+    return true;
+}
+
+uint32_t hostIdFromName(const std::string& name)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
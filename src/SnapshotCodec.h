@@ -0,0 +1,102 @@
+#ifndef SRC_SNAPSHOTCODEC_H
+#define SRC_SNAPSHOTCODEC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+enum MetricId : size_t
+{
+    METRIC_CPU,       // permille
+    METRIC_MEMORY,    // MiB committed
+    METRIC_NETWORK,   // KiB/s received
+    METRIC_DISK,      // KiB/s read + written
+    METRIC_PROCESS,   // permille of the busiest process
+    METRIC_COUNT,
+};
+
+// one tick of numeric metrics. invalid entries are always zero so that both sides of
+// the delta encoding agree on the base value.
+struct MetricTable
+{
+    std::array<int64_t, METRIC_COUNT> values{};
+    uint32_t validMask = 0;
+
+    void set(MetricId id, int64_t value)
+    {
+        values[id] = value;
+        validMask |= 1u << id;
+    }
+
+    bool valid(MetricId id) const
+    {
+        return (validMask >> id) & 1u;
+    }
+};
+
+// wire format, version 2:
+//   u8 magic, u8 version, u8 flags (bit 0: keyframe)
+//   varint host id, varint sequence, varint valid mask
+//   zigzag varint per valid metric: value - last keyframe's value (0 in keyframes)
+//   keyframes only: varint name length, utf-8 host name
+// every sequence that is a multiple of KEYFRAME_INTERVAL is a keyframe. a typical delta
+// frame is 10-20 bytes, a keyframe a few bytes more plus the name.
+class SnapshotEncoder
+{
+public:
+    SnapshotEncoder(uint32_t hostId, std::string hostName);
+
+    // returns the frame size, or 0 if out is too small
+    size_t encode(const MetricTable& table, std::span<uint8_t> out);
+
+    static constexpr size_t MAX_FRAME_SIZE = 512;
+    // utf-8 bytes; a longer name would not fit a keyframe and nothing would ever be sent
+    static constexpr size_t MAX_HOST_NAME_SIZE = 255;
+
+    // deltas only depend on the keyframe, so a lost delta costs one update; a lost
+    // keyframe costs the frames up to the next one
+    static constexpr uint32_t KEYFRAME_INTERVAL = 30;
+
+private:
+    uint32_t m_hostId;
+    std::string m_hostName;
+
+    uint32_t m_sequence = 0;
+    MetricTable m_keyframe;
+};
+
+struct FrameHeader
+{
+    uint32_t hostId = 0;
+    uint32_t sequence = 0;
+    bool keyframe = false;
+};
+
+// reads one frame front to back: header, then values, then (keyframes) the host name
+class FrameReader
+{
+public:
+    explicit FrameReader(std::span<const uint8_t> data);
+
+    bool readHeader(FrameHeader& header);
+
+    // keyframes are read as they are, delta frames relative to keyframe: the sender's
+    // keyframe the delta's sequence belongs to
+    bool readValues(const MetricTable& keyframe, MetricTable& table);
+
+    bool readHostName(std::string& name);
+
+private:
+    bool readVarint(uint64_t& value);
+
+    std::span<const uint8_t> m_data;
+    size_t m_offset = 0;
+    bool m_keyframe = false;
+};
+
+uint32_t hostIdFromName(const std::string& name);
+
+
+#endif //SRC_SNAPSHOTCODEC_H
\ No newline at end of file
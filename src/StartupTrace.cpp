@@ -0,0 +1,123 @@
+#include "StartupTrace.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <iostream>
+
+namespace
+{
+uint64_t toTicks(const FILETIME& ft)
+{
+    return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+}
+
+StartupTrace::StartupTrace()
+    : m_origin(Clock::now())
+{
+    // move the origin back to process creation so loader and CRT startup are counted too
+    FILETIME creation, exitTime, kernel, user, now;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user))
+    {
+        GetSystemTimePreciseAsFileTime(&now);
+        uint64_t nowTicks = toTicks(now);
+        uint64_t creationTicks = toTicks(creation);
+        if (nowTicks > creationTicks)
+        {
+            // FILETIME is in 100ns units
+            m_origin -= std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds((nowTicks - creationTicks) * 100));
+        }
+    }
+}
+
+StartupTrace::Phase::Phase(StartupTrace& trace, std::wstring name)
+    : m_trace(trace), m_name(std::move(name)), m_begin(Clock::now())
+{
+}
+
+StartupTrace::Phase::~Phase()
+{
+    m_trace.record(std::move(m_name), m_begin, Clock::now());
+}
+
+void StartupTrace::Phase::rename(std::wstring name)
+{
+    m_name = std::move(name);
+}
+
+StartupTrace::Phase StartupTrace::phase(std::wstring name)
+{
+    return Phase(*this, std::move(name));
+}
+
+void StartupTrace::firstFrame()
+{
+    std::lock_guard lock(m_mutex);
+    if (m_hasFirstFrame)
+    {
+        return;
+    }
+    m_hasFirstFrame = true;
+
+    auto now = Clock::now();
+    m_milestones.push_back(Entry{L"first frame", m_origin, now});
+}
+
+void StartupTrace::firstValidMetric(const std::wstring& name)
+{
+    std::lock_guard lock(m_mutex);
+    std::wstring label = L"first valid " + name;
+    if (std::ranges::any_of(m_milestones, [&](const Entry& e) { return e.name == label; }))
+    {
+        return;
+    }
+
+    auto now = Clock::now();
+    m_milestones.push_back(Entry{std::move(label), m_origin, now});
+}
+
+double StartupTrace::elapsedMs() const
+{
+    return sinceOrigin(Clock::now());
+}
+
+void StartupTrace::report()
+{
+    std::wstring text;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_reported)
+        {
+            return;
+        }
+        m_reported = true;
+
+        text += L"startup trace (ms since process creation)\n";
+        for (const Entry& e : m_phases)
+        {
+            text += std::format(L"  {:<24} {:>8.2f} .. {:>8.2f} ({:.2f})\n",
+                e.name, sinceOrigin(e.begin), sinceOrigin(e.end), sinceOrigin(e.end) - sinceOrigin(e.begin));
+        }
+        for (const Entry& e : m_milestones)
+        {
+            text += std::format(L"  {:<24} {:>8.2f}\n", e.name, sinceOrigin(e.end));
+        }
+    }
+
+    std::wcerr << text << std::flush;
+    OutputDebugString(text.c_str());
+}
+
+void StartupTrace::record(std::wstring name, Clock::time_point begin, Clock::time_point end)
+{
+    std::lock_guard lock(m_mutex);
+    m_phases.push_back(Entry{std::move(name), begin, end});
+}
+
+double StartupTrace::sinceOrigin(Clock::time_point t) const
+{
+    return std::chrono::duration<double, std::milli>(t - m_origin).count();
+}
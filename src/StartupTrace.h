@@ -0,0 +1,69 @@
+#ifndef SRC_STARTUPTRACE_H
+#define SRC_STARTUPTRACE_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// records how long each startup phase took, measured from process creation,
+// plus time-to-first-frame and time-to-first-valid-metric. thread-safe.
+class StartupTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StartupTrace();
+
+    class Phase
+    {
+    public:
+        Phase(StartupTrace& trace, std::wstring name);
+        ~Phase();
+
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+        // for phases whose outcome is only known at the end, e.g. cache hit or miss
+        void rename(std::wstring name);
+
+    private:
+        StartupTrace& m_trace;
+        std::wstring m_name;
+        Clock::time_point m_begin;
+    };
+
+    // times the enclosing scope
+    Phase phase(std::wstring name);
+
+    // only the first call of each is recorded
+    void firstFrame();
+    void firstValidMetric(const std::wstring& name);
+
+    double elapsedMs() const;
+
+    // writes the trace to stderr and the debugger once
+    void report();
+
+private:
+    struct Entry
+    {
+        std::wstring name;
+        Clock::time_point begin;
+        Clock::time_point end;
+    };
+
+    void record(std::wstring name, Clock::time_point begin, Clock::time_point end);
+    double sinceOrigin(Clock::time_point t) const;
+
+    Clock::time_point m_origin;
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_phases;
+    std::vector<Entry> m_milestones;
+    bool m_hasFirstFrame = false;
+    bool m_reported = false;
+};
+
+
+#endif //SRC_STARTUPTRACE_H
\ No newline at end of file
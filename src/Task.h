@@ -0,0 +1,89 @@
+#ifndef SRC_TASK_H
+#define SRC_TASK_H
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+// lazily started coroutine owned by its caller.
+// the frame stays alive after completion so the owner can poll done().
+class Task
+{
+public:
+    struct promise_type
+    {
+        Task get_return_object()
+        {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception()
+        {
+            exception = std::current_exception();
+        }
+
+        std::exception_ptr exception;
+    };
+
+    Task() = default;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    Task(Task&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr))
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    void start() const
+    {
+        m_handle.resume();
+    }
+
+    bool done() const
+    {
+        return !m_handle || m_handle.done();
+    }
+
+    std::exception_ptr exception() const
+    {
+        return m_handle ? m_handle.promise().exception : nullptr;
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+
+#endif //SRC_TASK_H
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local size_t currentIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t workerCount)
+{
+    workerCount = std::clamp<size_t>(workerCount, 1, MAX_WORKERS);
+
+    m_queues.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    m_threads.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_threads.emplace_back([this, i] { loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+size_t ThreadPool::defaultWorkerCount()
+{
+    // at least two so one hung provider cannot starve the rest
+    return std::max<size_t>(std::thread::hardware_concurrency() / 2, 2);
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    if (m_stopping.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    size_t index = currentPool == this
+        ? currentIndex
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    // counted before it becomes visible so a thief can never drive the count below zero
+    m_pending.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard lock(m_queues[index]->mutex);
+        m_queues[index]->jobs.push_back(std::move(job));
+    }
+
+    {
+        // pairs with the predicate check in loop() so the wakeup cannot be lost
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_sleepCv.notify_one();
+}
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_sleepCv.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    for (auto& queue : m_queues)
+    {
+        std::lock_guard lock(queue->mutex);
+        queue->jobs.clear();
+    }
+}
+
+void ThreadPool::loop(size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    std::function<void()> job;
+    while (!m_stopping.load(std::memory_order_relaxed))
+    {
+        if (tryPop(index, job))
+        {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        std::unique_lock lock(m_sleepMutex);
+        m_sleepCv.wait(lock, [this] {
+            return m_stopping.load(std::memory_order_relaxed) || m_pending.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+bool ThreadPool::tryPop(size_t index, std::function<void()>& job)
+{
+    {
+        Queue& own = *m_queues[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t k = 1; k < m_queues.size(); k++)
+    {
+        Queue& victim = *m_queues[(index + k) % m_queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,62 @@
+#ifndef SRC_THREADPOOL_H
+#define SRC_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// small work-stealing pool. each worker owns a deque: it pops its own jobs from the
+// back and steals from the front of the others when it runs dry.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t workerCount = defaultWorkerCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // jobs submitted from a worker stay on that worker's deque
+    void submit(std::function<void()> job);
+
+    // finishes running jobs and joins; queued jobs are dropped
+    void stop();
+
+    size_t workerCount() const
+    {
+        return m_queues.size();
+    }
+
+    static size_t defaultWorkerCount();
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    void loop(size_t index);
+    bool tryPop(size_t index, std::function<void()>& job);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::atomic<size_t> m_nextQueue = 0;
+    std::atomic<size_t> m_pending = 0;
+    std::atomic<bool> m_stopping = false;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCv;
+
+    const size_t MAX_WORKERS = 8;
+};
+
+
+#endif //SRC_THREADPOOL_H
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "Utf8.h"
+
+// hand-rolled rather than WideCharToMultiByte, so the fleet host table builds off
+// Windows too. wchar_t is UTF-16 on Windows and UTF-32 elsewhere; malformed input
+// becomes U+FFFD, as the Win32 conversions do without MB_ERR_INVALID_CHARS
+namespace
+{
+constexpr char32_t REPLACEMENT = 0xFFFD;
+
+bool isSurrogate(char32_t c)
+{
+    return c >= 0xD800 && c <= 0xDFFF;
+}
+
+void appendUtf8(std::string& out, char32_t c)
+{
+    if (c < 0x80)
+    {
+        out += static_cast<char>(c);
+    }
+    else if (c < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+    else if (c < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (c >> 18));
+        out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+void appendWide(std::wstring& out, char32_t c)
+{
+    if (sizeof(wchar_t) == 2 && c >= 0x10000)
+    {
+        c -= 0x10000;
+        out += static_cast<wchar_t>(0xD800 + (c >> 10));
+        out += static_cast<wchar_t>(0xDC00 + (c & 0x3FF));
+        return;
+    }
+    out += static_cast<wchar_t>(c);
+}
+
+// decodes the sequence at str[i] and advances i past it; a malformed one yields
+// REPLACEMENT and skips a single byte
+char32_t decodeUtf8(const std::string& str, size_t& i)
+{
+    auto lead = static_cast<unsigned char>(str[i++]);
+    if (lead < 0x80)
+    {
+        return lead;
+    }
+
+    size_t length = 0;
+    char32_t c = 0;
+    char32_t min = 0;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        length = 1;
+        c = lead & 0x1F;
+        min = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length = 2;
+        c = lead & 0x0F;
+        min = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length = 3;
+        c = lead & 0x07;
+        min = 0x10000;
+    }
+    else
+    {
+        return REPLACEMENT;
+    }
+
+    if (str.size() - i < length)
+    {
+        return REPLACEMENT;
+    }
+    for (size_t k = 0; k < length; k++)
+    {
+        auto next = static_cast<unsigned char>(str[i + k]);
+        if ((next & 0xC0) != 0x80)
+        {
+            return REPLACEMENT;
+        }
+        c = (c << 6) | (next & 0x3F);
+    }
+    if (c < min || c > 0x10FFFF || isSurrogate(c))
+    {
+        return REPLACEMENT;
+    }
+
+    i += length;
+    return c;
+}
+}
+
+std::string toUtf8(const std::wstring& str)
+{
+    std::string result;
+    result.reserve(str.size());
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        auto c = static_cast<char32_t>(str[i]);
+        if (sizeof(wchar_t) == 2 && c >= 0xD800 && c <= 0xDBFF && i + 1 < str.size()
+            && str[i + 1] >= 0xDC00 && str[i + 1] <= 0xDFFF)
+        {
+            c = 0x10000 + ((c - 0xD800) << 10) + (static_cast<char32_t>(str[++i]) - 0xDC00);
+        }
+        else if (isSurrogate(c) || c > 0x10FFFF)
+        {
+            c = REPLACEMENT;
+        }
+        appendUtf8(result, c);
+    }
+    return result;
+}
+
+void assignFromUtf8(std::wstring& out, const std::string& str)
+{
+    out.clear();
+    size_t i = 0;
+    while (i < str.size())
+    {
+        appendWide(out, decodeUtf8(str, i));
+    }
+}
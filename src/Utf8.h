@@ -0,0 +1,12 @@
+#ifndef SRC_UTF8_H
+#define SRC_UTF8_H
+
+#include <string>
+
+std::string toUtf8(const std::wstring& str);
+
+// reuses out's capacity, so a steady stream of names allocates nothing
+void assignFromUtf8(std::wstring& out, const std::string& str);
+
+
+#endif //SRC_UTF8_H
\ No newline at end of file
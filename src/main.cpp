@@ -1,17 +1,64 @@
 #include "App.h"
+#include "Headless.h"
 
 #include <windows.h>
 
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
 int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 {
-    App app;
-    if (app.createWindow() != 0)
+    Options options;
+    try
+    {
+        options = parseOptions();
+    }
+    catch (const std::exception& e)
+    {
+        MessageBoxA(nullptr, e.what(), "Invalid arguments", MB_OK | MB_ICONERROR);
+        return -1;
+    }
+
+    if (options.headless())
+    {
+        // no window, device or fonts: nothing but counters between start and first output
+        try
+        {
+            Headless headless(options);
+            return headless.run();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // layouts are in DIPs and scaled per monitor; without this Windows would stretch a 96 DPI bitmap
+    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+
+    // the fleet sockets are opened up front, so a bad target or a taken port fails here
+    std::unique_ptr<App> app;
+    try
+    {
+        app = std::make_unique<App>(options);
+    }
+    catch (const std::exception& e)
+    {
+        MessageBoxA(nullptr, e.what(), "Failed to start", MB_OK | MB_ICONERROR);
+        return -1;
+    }
+
+    // the aggregator grid needs room below the clock
+    int result = options.aggregatePort ? app->createWindow(1280, 900) : app->createWindow();
+    if (result != 0)
     {
         return -1;
     }
-    app.initD2D();
+    app->initD2D();
 
-    app.run();
+    app->run();
 
     return 0;
 }
\ No newline at end of file